@@ -174,7 +174,7 @@ void R_Type::Hud::startLevelAnimation(int level, engine::registry &registry)
 
     for (size_t i = 0; i < levelTags.size(); ++i)
         if (levelTags[i].has_value())
-            _registry.kill_entity(engine::entity_t{i});
+            _registry.kill_entity(_registry.entity_from_index(i));
 
 }
 
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include "Interpolation.hpp"
+#include "engine/ecs/Components.hpp"
+#include "common/Packets.hpp"
+
+void R_Type::SnapshotInterpolator::setTickRate(uint32_t tickRate)
+{
+    _tickRate = std::max<uint32_t>(tickRate, 1);
+}
+
+void R_Type::SnapshotInterpolator::setDelay(float ms)
+{
+    _delayMs = std::max(ms, 0.f);
+}
+
+void R_Type::SnapshotInterpolator::push(std::size_t id, uint32_t tick, float x, float y)
+{
+    if (!_started || tick > _newestTick)
+        _newestTick = tick;
+    if (!_started)
+    {
+        _renderTick = static_cast<double>(tick) - delayTicks();
+        _started = true;
+    }
+
+    if (id >= _tracks.size())
+        _tracks.resize(id + 1);
+    Track &track = _tracks[id];
+    if (track.count > 0)
+    {
+        const Sample &newest = track.at(0);
+        if (tick < newest.tick)
+            return;
+        if (tick == newest.tick)
+        {
+            track.samples[track.head] = Sample{tick, x, y};
+            return;
+        }
+        track.head = (track.head + 1) & (history_size - 1);
+    }
+    track.samples[track.head] = Sample{tick, x, y};
+    track.count = std::min(track.count + 1, history_size);
+}
+
+void R_Type::SnapshotInterpolator::forget(std::size_t id)
+{
+    if (id < _tracks.size())
+        _tracks[id].count = 0;
+}
+
+void R_Type::SnapshotInterpolator::clear()
+{
+    _tracks.clear();
+    _newestTick = 0;
+    _started = false;
+    _renderTick = 0.0;
+}
+
+void R_Type::SnapshotInterpolator::advance(float dt)
+{
+    if (!_started)
+        return;
+    const double delay = delayTicks();
+    const double target = static_cast<double>(_newestTick) - delay;
+    const double limit = std::max(delay, 4.0);
+    const double error = target - (_renderTick + static_cast<double>(dt) * _tickRate);
+
+    // Far behind: jump. Far ahead means snapshots stopped coming: wait for them rather than
+    // running away or stepping back. Anything smaller is jitter, of which a share of the gap
+    // is closed per second so entities never visibly speed up or stop.
+    if (error > limit)
+        _renderTick = target;
+    else if (error >= -limit)
+        _renderTick += static_cast<double>(dt) * _tickRate + error * std::min(1.0, static_cast<double>(dt) * 4.0);
+}
+
+uint32_t R_Type::SnapshotInterpolator::viewTick() const
+{
+    if (!_started || _renderTick < 0.0)
+        return INPUT_NO_TICK;
+    return static_cast<uint32_t>(_renderTick);
+}
+
+bool R_Type::SnapshotInterpolator::sample(const Track &track, float &x, float &y) const
+{
+    if (track.count == 0)
+        return false;
+
+    const Sample &newest = track.at(0);
+    if (_renderTick >= newest.tick)
+    {
+        x = newest.x;
+        y = newest.y;
+        if (track.count < 2)
+            return true;
+        // Late or lost snapshot: carry on along the last known motion for a little while
+        const Sample &prev = track.at(1);
+        const float dx = newest.x - prev.x;
+        const float dy = newest.y - prev.y;
+        if (std::abs(dx) + std::abs(dy) > teleport_distance)
+            return true;
+        const float span = static_cast<float>(newest.tick - prev.tick);
+        const float ahead = std::min(static_cast<float>(_renderTick - newest.tick), max_extrapolation_ticks);
+        x += dx / span * ahead;
+        y += dy / span * ahead;
+        return true;
+    }
+
+    // Newest sample at or before the render tick, walking back from the most recent
+    for (std::size_t age = 1; age < track.count; ++age)
+    {
+        const Sample &from = track.at(age);
+        if (from.tick > _renderTick)
+            continue;
+        const Sample &to = track.at(age - 1);
+        x = from.x;
+        y = from.y;
+        if (std::abs(to.x - from.x) + std::abs(to.y - from.y) > teleport_distance)
+            return true;
+        const float t = static_cast<float>((_renderTick - from.tick) / (to.tick - from.tick));
+        x += (to.x - from.x) * t;
+        y += (to.y - from.y) * t;
+        return true;
+    }
+
+    // Render tick older than the whole history (entity just appeared): hold its first state
+    const Sample &oldest = track.at(track.count - 1);
+    x = oldest.x;
+    y = oldest.y;
+    return true;
+}
+
+void R_Type::SnapshotInterpolator::apply(engine::registry &reg) const
+{
+    auto &positions = reg.get_components<component::position>();
+    const std::size_t bound = std::min(_tracks.size(), positions.size());
+    for (std::size_t id = 0; id < bound; ++id)
+    {
+        float x = 0.f;
+        float y = 0.f;
+        if (!positions[id] || !sample(_tracks[id], x, y))
+            continue;
+        positions[id]->x = x;
+        positions[id]->y = y;
+    }
+}
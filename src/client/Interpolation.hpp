@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "engine/ecs/Registry.hpp"
+
+/**
+ * @file Interpolation.hpp
+ * @brief Defines the SnapshotInterpolator class, which renders server entities a little in the past.
+ *
+ * Writing each snapshot straight into the registry shows every late or lost packet as a
+ * stutter. Instead, the client keeps the last few positions of each server entity keyed by
+ * server tick and draws the entity at a render tick that trails the newest snapshot by a fixed
+ * delay, blending between the two states around it. As long as one snapshot per delay gets
+ * through, motion stays smooth, which also lets the server send snapshots less often.
+ */
+
+namespace R_Type
+{
+    /**
+     * @class SnapshotInterpolator
+     * @brief Per-entity snapshot history and the render clock used to sample it.
+     *
+     * Entities are identified by their local registry index. When the render tick passes the
+     * newest sample, the interpolator extrapolates from the last two samples for at most
+     * max_extrapolation_ticks, then holds the position.
+     */
+    class SnapshotInterpolator
+    {
+    public:
+        static constexpr std::size_t history_size = 16; // samples kept per entity, power of two
+        static constexpr float default_delay_ms = 100.f;
+        static constexpr float max_extrapolation_ticks = 6.f;
+        // Moves larger than this between two samples are teleports (bounds wrap): no blending
+        static constexpr float teleport_distance = 400.f;
+
+        void setTickRate(uint32_t tickRate);
+        void setDelay(float ms);
+        float delayMs() const { return _delayMs; }
+
+        /**
+         * @brief Records the server position of a local entity at a server tick.
+         *
+         * Samples older than the entity's newest one are ignored; a sample for the same tick
+         * replaces it.
+         */
+        void push(std::size_t id, uint32_t tick, float x, float y);
+
+        // Drops the history of a local entity, before its index is recycled
+        void forget(std::size_t id);
+
+        // Drops every history and restarts the render clock (new connection)
+        void clear();
+
+        /**
+         * @brief Advances the render clock by dt seconds.
+         *
+         * The clock runs at the server tick rate and is steered towards newest tick - delay, so
+         * it absorbs jitter instead of following each arrival. It jumps when far behind (first
+         * snapshot) and stops when far ahead (snapshots no longer arriving).
+         */
+        void advance(float dt);
+
+        // Server tick remote entities are currently drawn at, INPUT_NO_TICK before the first snapshot
+        uint32_t viewTick() const;
+
+        // Writes the position at the render tick of every entity with a history
+        void apply(engine::registry &reg) const;
+
+    private:
+        struct Sample
+        {
+            uint32_t tick;
+            float x, y;
+        };
+
+        struct Track
+        {
+            std::array<Sample, history_size> samples;
+            std::size_t head = 0;  // slot of the newest sample
+            std::size_t count = 0; // 0 for an entity without history
+
+            const Sample &at(std::size_t age) const { return samples[(head - age) & (history_size - 1)]; }
+        };
+
+        bool sample(const Track &track, float &x, float &y) const;
+        float delayTicks() const { return _delayMs * static_cast<float>(_tickRate) / 1000.f; }
+
+        std::vector<Track> _tracks; // indexed by local entity id
+        uint32_t _tickRate = 60;
+        float _delayMs = default_delay_ms;
+        uint32_t _newestTick = 0;
+        bool _started = false;
+        double _renderTick = 0.0;
+    };
+}
@@ -19,6 +19,16 @@ int main(int argc, char* argv[])
             std::cerr << "Invalid port argument. Using default 4242\n";
         }
     }
+    float interpDelayMs = R_Type::SnapshotInterpolator::default_delay_ms;
+    if (argc >= 4)
+    {
+        try {
+            interpDelayMs = std::stof(argv[3]);
+        } catch (...) {
+            std::cerr << "Invalid interpolation delay argument. Using default "
+                      << interpDelayMs << " ms\n";
+        }
+    }
     try
     {
         R_Type::Rtype game;
@@ -27,6 +37,7 @@ int main(int argc, char* argv[])
         std::cout << "[Profiling] System enabled. Press F3 to toggle overlay.\n";
 
         game.setServerEndpoint(serverIp, port);
+        game.setInterpolationDelay(interpDelayMs);
         game.getApp().run(
             [&game](float dt, const std::vector<engine::R_Events::Event> &events)
             {
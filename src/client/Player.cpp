@@ -231,9 +231,7 @@ void R_Type::Player::ensureChargeOverlay(engine::registry& registry, size_t play
             registry.add_component(e, component::entity_kind::decor);
             registry.emplace_component<component::drawable>(e, chargeTexture, chargeRect, layers::Effects);
             registry.add_component(e, component::animation{});
-            auto &hitboxes = registry.get_components<component::hitbox>();
-            if (idx < hitboxes.size() && hitboxes[idx])
-                hitboxes[idx].reset();
+            registry.remove_component<component::hitbox>(e);
             auto &anims = registry.get_components<component::animation>();
             if (idx < anims.size() && anims[idx]) {
                 *anims[idx] = chargeAnimation;
@@ -244,7 +242,7 @@ void R_Type::Player::ensureChargeOverlay(engine::registry& registry, size_t play
         if (chargeOverlayLocalId.has_value()) {
             size_t idx = chargeOverlayLocalId.value();
             if (idx != playerLocalId) {
-                engine::entity_t e = static_cast<engine::entity_t>(idx);
+                engine::entity_t e = registry.entity_from_index(idx);
                 registry.kill_entity(e);
             }
             chargeOverlayLocalId.reset();
@@ -0,0 +1,78 @@
+#include <cmath>
+#include "Prediction.hpp"
+#include "common/PlayerMovement.hpp"
+
+void R_Type::PlayerPredictor::step(component::position &pos, const Input &input)
+{
+    const component::velocity vel = player_velocity(input.actions);
+    pos.x += vel.vx * input.dt;
+    pos.y += vel.vy * input.dt;
+    clamp_player_position(pos);
+}
+
+void R_Type::PlayerPredictor::record(uint32_t tick, uint8_t actions, float dt)
+{
+    // Full history: the server is far behind, the oldest input is the least useful
+    if (_count == history_size)
+    {
+        _first = (_first + 1) & (history_size - 1);
+        --_count;
+    }
+    const Input input{tick, actions, dt};
+    _inputs[(_first + _count) & (history_size - 1)] = input;
+    ++_count;
+    if (_hasBase)
+        step(_predicted, input);
+}
+
+void R_Type::PlayerPredictor::reconcile(uint32_t inputTick, float x, float y)
+{
+    component::position shown{};
+    const bool hadBase = position(shown);
+
+    if (inputTick != INPUT_NO_TICK)
+    {
+        while (_count > 0 && _inputs[_first].tick <= inputTick)
+        {
+            _first = (_first + 1) & (history_size - 1);
+            --_count;
+        }
+    }
+    _predicted = component::position{x, y};
+    for (std::size_t k = 0; k < _count; ++k)
+        step(_predicted, _inputs[(_first + k) & (history_size - 1)]);
+    _hasBase = true;
+
+    _offset = component::position{};
+    if (hadBase)
+    {
+        const float dx = shown.x - _predicted.x;
+        const float dy = shown.y - _predicted.y;
+        if (std::abs(dx) + std::abs(dy) < snap_distance)
+            _offset = component::position{dx, dy};
+    }
+}
+
+void R_Type::PlayerPredictor::update(float dt)
+{
+    const float keep = std::exp(-correction_rate * dt);
+    _offset.x *= keep;
+    _offset.y *= keep;
+}
+
+void R_Type::PlayerPredictor::reset()
+{
+    _first = 0;
+    _count = 0;
+    _predicted = component::position{};
+    _offset = component::position{};
+    _hasBase = false;
+}
+
+bool R_Type::PlayerPredictor::position(component::position &out) const
+{
+    if (!_hasBase)
+        return false;
+    out = component::position{_predicted.x + _offset.x, _predicted.y + _offset.y};
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "engine/ecs/Components.hpp"
+
+/**
+ * @file Prediction.hpp
+ * @brief Defines the PlayerPredictor class, which moves the local ship before the server confirms it.
+ *
+ * Waiting for the server to echo the ship position makes every input a full round trip late.
+ * The client instead applies each input to its own ship at once, with the server's movement
+ * rules (common/PlayerMovement.hpp), and remembers it under its InputPacket::tick. Snapshots
+ * tell which input the server applied last: the predictor restarts from the server position
+ * and replays the inputs sent after it.
+ */
+
+namespace R_Type
+{
+    /**
+     * @class PlayerPredictor
+     * @brief Input history and predicted position of the local ship.
+     *
+     * A reconciliation that lands away from the displayed position (timing drift, server-side
+     * collision) is not shown as a jump: the difference is kept as an offset that fades over
+     * a few frames. Beyond snap_distance the ship jumps anyway (respawn, level change).
+     */
+    class PlayerPredictor
+    {
+    public:
+        static constexpr std::size_t history_size = 256; // inputs not yet applied by the server; power of two
+        static constexpr float snap_distance = 200.f;
+        static constexpr float correction_rate = 10.f; // share of the offset removed per second
+
+        /**
+         * @brief Records the input sent for `tick` and moves the prediction by it.
+         * @param dt Time the actions were held for, in seconds, already scaled by
+         *        game_speed_factor() like the server's tick dt.
+         */
+        void record(uint32_t tick, uint8_t actions, float dt);
+
+        /**
+         * @brief Restarts the prediction from a server position.
+         * @param inputTick Last input the server applied (INPUT_NO_TICK if none): the inputs up
+         *        to it are dropped and the later ones replayed.
+         */
+        void reconcile(uint32_t inputTick, float x, float y);
+
+        // Fades the reconciliation offset
+        void update(float dt);
+
+        // Drops the history and the prediction (new connection, ship gone)
+        void reset();
+
+        // Position to display; false before the first reconciliation
+        bool position(component::position &out) const;
+
+    private:
+        struct Input
+        {
+            uint32_t tick;
+            uint8_t actions;
+            float dt;
+        };
+
+        static void step(component::position &pos, const Input &input);
+
+        std::array<Input, history_size> _inputs{};
+        std::size_t _first = 0; // slot of the oldest input
+        std::size_t _count = 0;
+        component::position _predicted{};
+        component::position _offset{}; // displayed - predicted, fading to zero
+        bool _hasBase = false;
+    };
+}
@@ -8,6 +8,7 @@
 #include "common/Packets.hpp"
 #include "engine/network/UdpSocket.hpp"
 #include "common/Accessibility.hpp"
+#include "common/PlayerMovement.hpp"
 #include "engine/ecs/Systems.hpp"
 #include "Background.hpp"
 #include "Hud.hpp"
@@ -59,6 +60,8 @@ R_Type::Rtype::Rtype()
         _registry.register_component<component::hud_tag>();
         _registry.register_component<component::health>();
         _registry.register_component<component::hitbox>();
+        // handle_collision only reacts to player projectiles hitting enemies
+        _collisionMatrix.allow(component::entity_kind::playerProjectile, component::entity_kind::enemy);
         _background = std::make_unique<Background>(*this);
         _playerData = std::make_unique<Player>(*this);
         _enemyData = std::make_unique<Enemy>(*this);
@@ -95,10 +98,9 @@ void R_Type::Rtype::update(float deltaTime,
         {
             _inMenu = false;
             ConnectReq req{42};
-            PacketHeader hdr{CONNECT_REQ, sizeof(ConnectReq), 0};
-            std::vector<uint8_t> buf(sizeof(ConnectReq));
-            std::memcpy(buf.data(), &req, sizeof(ConnectReq));
-            _client->send(hdr, buf, *_serverEndpoint);
+            _client->send(CONNECT_REQ, req, *_serverEndpoint);
+            // Picks up key remaps from settings changed in the menu
+            _inputBindings = InputBindings::fromConfig();
             std::cout << "Sent CONNECT_REQ\n";
         }
         return;
@@ -155,30 +157,21 @@ void R_Type::Rtype::update(float deltaTime,
     }
     prevCombo = combo;
     
+    const uint8_t actions = _inputBindings.actions(_pressedKeys);
     {
         PROFILE_SCOPE("Network Send");
         InputPacket inp{};
         inp.clientId = _player;
         inp.tick = _tick++;
-        inp.keyCount = static_cast<uint16_t>(_pressedKeys.size());
-        const uint16_t keyCount = inp.keyCount;
-        std::vector<int32_t> keys;
-        keys.reserve(keyCount);
-        for (auto k : _pressedKeys)
-            keys.push_back(static_cast<int32_t>(k));
-        const uint16_t payloadSize = sizeof(InputPacket) + keyCount * sizeof(int32_t);
-        PacketHeader ihdr{INPUT_PKT, payloadSize, _tick};
-        std::vector<uint8_t> ibuf(payloadSize);
-        std::memcpy(ibuf.data(), &inp, sizeof(InputPacket));
-        if (keyCount > 0)
-            std::memcpy(ibuf.data() + sizeof(InputPacket), keys.data(), keyCount * sizeof(int32_t));
-        _client->send(ihdr, ibuf, *_serverEndpoint);
+        inp.ackSequence = _lastSnapshotSequence;
+        inp.viewTick = _interpolator.viewTick();
+        inp.actions = actions;
+        _client->send(INPUT_PKT, inp, *_serverEndpoint, _tick);
+        _predictor.record(inp.tick, actions, deltaTime * game_speed_factor());
     }
 
     static uint32_t spaceHoldTicks = 0;
-    auto shootKeyStr = AccessibilityConfig::key_remap["shoot"];
-    auto shootKey = stringToKey(shootKeyStr);
-    bool spaceHeld = _pressedKeys.count(shootKey) > 0;
+    bool spaceHeld = (actions & INPUT_FIRE) != 0;
     int numKeys = 0;
     const Uint8 *state = SDL_GetKeyboardState(&numKeys);
     if (state && SDL_SCANCODE_SPACE < numKeys)
@@ -210,12 +203,21 @@ void R_Type::Rtype::update(float deltaTime,
     
     {
         PROFILE_SCOPE("Game Systems");
-        float adjustedDelta = deltaTime * (AccessibilityConfig::enabled ? AccessibilityConfig::speed_game : 1.0f);
-        position_system(_registry, positions, velocities, adjustedDelta);
+        float adjustedDelta = deltaTime * game_speed_factor();
+        position_system(_registry, adjustedDelta);
+        _interpolator.advance(deltaTime);
+        _interpolator.apply(_registry);
+        _predictor.update(deltaTime);
+        auto local = _entityMap.find(_player);
+        component::position predicted;
+        if (local != _entityMap.end() && local->second < positions.size() && positions[local->second] &&
+            _predictor.position(predicted))
+            *positions[local->second] = predicted;
         control_system(_registry, velocities, controls);
         scroll_reset_system(_registry, positions, kinds, _app);
         animation_system(_registry, animations, drawables, adjustedDelta);
-        hitbox_system(_registry, positions, hitboxes, [this](size_t i, size_t j)
+        hitbox_system(_registry, positions, hitboxes, kinds, _collisionMatrix, _broadphase,
+                      [this](size_t i, size_t j)
                       { this->handle_collision(_registry, i, j); });
         lifetime_system(_registry, adjustedDelta);
         _registry.run_systems();
@@ -223,8 +225,9 @@ void R_Type::Rtype::update(float deltaTime,
     }
     
     // Update world metrics
-    auto playerPos = (_player < positions.size() && positions[_player]) 
-                     ? positions[_player].value() 
+    auto ship = _entityMap.find(_player);
+    auto playerPos = (ship != _entityMap.end() && ship->second < positions.size() && positions[ship->second])
+                     ? positions[ship->second].value()
                      : component::position{0, 0};
     profiler.setWorldPosition(playerPos.x, playerPos.y);
     profiler.setEntityCount(_activeEntities.size());
@@ -238,7 +241,7 @@ void R_Type::Rtype::receiveSnapshot()
     {
         auto [shdr, spayload] = *pkt_opt;
 
-        if (_state == GameState::LOADING && shdr.type == SNAPSHOT)
+        if (_state == GameState::LOADING && (shdr.type == SNAPSHOT || shdr.type == SNAPSHOT_DELTA))
             continue;
 
         if (shdr.type == GAME_OVER && spayload.size() >= sizeof(GameOverPayload))
@@ -274,222 +277,228 @@ void R_Type::Rtype::receiveSnapshot()
             std::cout << "[CLIENT] LEVEL_END : " << p.level << std::endl;
             std::cout << "[CLIENT] Entering LOADING state" << std::endl;
         }
+        if (shdr.type == SNAPSHOT_DELTA && spayload.size() >= sizeof(DeltaSnapshot))
+        {
+            DeltaSnapshot snap{};
+            auto states = std::make_shared<snapshot::States>();
+            if (!snapshot::read_delta(spayload.data(), spayload.size(), _snapshotHistory, snap, *states))
+                continue;
+            // Out-of-order delivery: never apply an older world state over a newer one
+            if (_lastSnapshotSequence != SNAPSHOT_NO_BASELINE && snap.sequence <= _lastSnapshotSequence)
+                continue;
+            _snapshotHistory.push(snap.sequence, states);
+            _lastSnapshotSequence = snap.sequence;
+            applySnapshot(snap.tick, snap.inputTick, states->data(), states->size());
+        }
         if (shdr.type == SNAPSHOT && spayload.size() >= sizeof(Snapshot))
         {
             Snapshot snap{};
             std::memcpy(&snap, spayload.data(), sizeof(Snapshot));
+            size_t n = snap.entityCount;
+            if (spayload.size() >= sizeof(Snapshot) + n * sizeof(EntityState))
+                applySnapshot(snap.tick, INPUT_NO_TICK, reinterpret_cast<const EntityState *>(spayload.data() + sizeof(Snapshot)), n);
+        }
+    }
+}
 
-            auto &positions = _registry.get_components<component::position>();
-            auto &velocities = _registry.get_components<component::velocity>();
-            auto &drawables = _registry.get_components<component::drawable>();
-            auto &kinds = _registry.get_components<component::entity_kind>();
-            auto &collisions = _registry.get_components<component::collision_state>();
-            auto &animations = _registry.get_components<component::animation>();
-            auto &hitboxes = _registry.get_components<component::hitbox>();
+void R_Type::Rtype::applySnapshot(uint32_t tick, uint32_t inputTick, const EntityState *entities, size_t n)
+{
+    auto &positions = _registry.get_components<component::position>();
+    auto &velocities = _registry.get_components<component::velocity>();
+    auto &drawables = _registry.get_components<component::drawable>();
+    auto &kinds = _registry.get_components<component::entity_kind>();
+    auto &collisions = _registry.get_components<component::collision_state>();
+    auto &animations = _registry.get_components<component::animation>();
+    auto &hitboxes = _registry.get_components<component::hitbox>();
 
-            std::unordered_set<uint32_t> newActive;
+    std::unordered_set<uint32_t> newActive;
 
-            size_t n = snap.entityCount;
-            if (spayload.size() >= sizeof(Snapshot) + n * sizeof(EntityState))
-            {
-                auto *entities = reinterpret_cast<const EntityState *>(
-                    spayload.data() + sizeof(Snapshot));
+    auto ensure_slot = [](auto &arr, std::size_t idx, auto &&value)
+    {
+        if (idx >= arr.size())
+        {
+            arr.insert_at(idx, std::forward<decltype(value)>(value));
+        }
+        else if (!arr[idx])
+        {
+            arr.insert_at(idx, std::forward<decltype(value)>(value));
+        }
+    };
 
-                auto ensure_slot = [](auto &arr, std::size_t idx, auto &&value)
-                {
-                    if (idx >= arr.size())
-                    {
-                        arr.insert_at(idx, std::forward<decltype(value)>(value));
-                    }
-                    else if (!arr[idx])
-                    {
-                        arr.insert_at(idx, std::forward<decltype(value)>(value));
-                    }
-                };
-
-                auto ensure_cache = [&](size_t idx)
-                {
-                    if (idx >= _hbW.size())
-                    {
-                        _hbW.resize(idx + 1, 0.f);
-                        _hbH.resize(idx + 1, 0.f);
-                        _hbOX.resize(idx + 1, 0.f);
-                        _hbOY.resize(idx + 1, 0.f);
-                    }
-                };
-
-                for (size_t i = 0; i < n; ++i)
-                {
-                    const EntityState &es = entities[i];
-
-                    size_t idLocal;
-                    auto it = _entityMap.find(es.entityId);
-                    if (it == _entityMap.end())
-                    {
-                        idLocal = drawables.size();
-                        _entityMap[es.entityId] = idLocal;
-                    }
-                    else
-                    {
-                        idLocal = it->second;
-                    }
-                    auto &hudTags = _registry.get_components<component::hud_tag>();
-                    auto &kindsLocal = _registry.get_components<component::entity_kind>();
-
-                    if (idLocal < hudTags.size() && hudTags[idLocal].has_value())
-                        continue;
-                    if (idLocal < kindsLocal.size()
-                        && kindsLocal[idLocal].has_value()
-                        && kindsLocal[idLocal].value() == component::entity_kind::decor)
-                        continue;
-                    ensure_cache(idLocal);
-                    newActive.insert(idLocal);
-
-                    ensure_slot(positions, idLocal, component::position{});
-                    ensure_slot(velocities, idLocal, component::velocity{});
-                    ensure_slot(kinds, idLocal, component::entity_kind{});
-                    ensure_slot(collisions, idLocal, component::collision_state{});
-                    kinds[idLocal] = static_cast<component::entity_kind>(es.type);
-                    ensure_slot(hitboxes, idLocal, component::hitbox{});
-                    std::shared_ptr<R_Graphic::Texture> tex;
-                    R_Graphic::textureRect rect;
-                    component::animation anim;
-                    switch (kinds[idLocal].value())
-                    {
-                    case component::entity_kind::playerProjectile:
-                        anim = _playerData->projectileAnimation;
-                        tex = _playerData->projectileTexture;
-                        rect = _playerData->projectileRect;
-                        ensure_slot(hitboxes, idLocal, component::hitbox{100, 24});
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
-                        break;
-                    case component::entity_kind::projectile_charged:
-                        anim = _playerData->chargeProjectileAnimation;
-                        tex = _playerData->chargeProjectileTexture;
-                        rect = _playerData->chargeProjectileRect;
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
-                        break;
-                    case component::entity_kind::projectile_bomb:
-                        anim = _playerData->missileProjectileAnimation;
-                        tex = _playerData->missileProjectileTexture;
-                        rect = _playerData->missileProjectileRect;
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
-                        break;
-                    case component::entity_kind::missile_explosion:
-                        anim = _playerData->missileexplosionAnimation;
-                        tex = _playerData->missileExplosionTexture;
-                        rect = _playerData->missileexplosionRect;
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Effects});
-                        break;
-                    case component::entity_kind::player:
-                        anim = _playerData->playerAnimation;
-                        tex = _playerData->playerTexture;
-                        rect = _playerData->playerRect;
-                        ensure_slot(hitboxes, idLocal, component::hitbox{34, 20});
-                        if (_playerIndexByLocalId.find(idLocal) == _playerIndexByLocalId.end())
-                        {
-                            int assigned = static_cast<int>((_playerIndexByLocalId.size() % 5) + 1);
-                            _playerIndexByLocalId[idLocal] = assigned;
-                        }
-                        {
-                            const int playerIndex = _playerIndexByLocalId[idLocal];
-                            const int rowOffset = (playerIndex - 1) * 17;
-                            for (auto &kv : anim.clips)
-                            {
-                                kv.second.startY = rowOffset;
-                            }
-                        }
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Players});
-                        break;
-                    case component::entity_kind::enemyProjectile:
-                        anim = _enemyData->projectileAnimation;
-                        tex = _enemyData->projectileTexture;
-                        rect = _enemyData->projectileRect;
-                        ensure_slot(hitboxes, idLocal, component::hitbox{60, 60});
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
-                        break;
-                    case component::entity_kind::enemy:
-                    if (es.entityId % 3 == 0)
-                        _enemyData->setType("boss");
-                    else if (es.entityId % 2 == 0)
-                        _enemyData->setType("shooter");
-                    else
-                        _enemyData->setType("crawler");
-                        tex = _enemyData->enemyTexture;
-                        rect = _enemyData->enemyRect;
-                        ensure_slot(hitboxes, idLocal, component::hitbox{152, 100});
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Enemies});
-                        break;
-                    default:
-                        tex = _playerData->playerTexture;
-                        rect = _playerData->playerRect;
-                        ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Effects});
-                        break;
-                    }
-                    ensure_slot(animations, idLocal, anim);
-
-                    positions[idLocal]->x = es.x;
-                    positions[idLocal]->y = es.y;
-                    hitboxes[idLocal]->width = es.hb_w;
-                    hitboxes[idLocal]->height = es.hb_h;
-                    hitboxes[idLocal]->offset_x = es.hb_ox;
-                    hitboxes[idLocal]->offset_y = es.hb_oy;
-                    _hbW[idLocal] = es.hb_w;
-                    _hbH[idLocal] = es.hb_h;
-                    _hbOX[idLocal] = es.hb_ox;
-                    _hbOY[idLocal] = es.hb_oy;
-                    if (idLocal < kinds.size() && kinds[idLocal] &&
-                        kinds[idLocal].value() == component::entity_kind::projectile_bomb)
-                    {
-                        ensure_slot(animations, idLocal, component::animation{});
-                        auto &an = *animations[idLocal];
-                        if (es.vy < 0.f)
-                            setAnimation(an, "rotation", false);
-                        else
-                            setAnimation(an, "idle", false);
-                    }
-                    collisions[idLocal]->collided = (es.collided != 0);
-                }
-            }
+    auto ensure_cache = [&](size_t idx)
+    {
+        if (idx >= _hbW.size())
+        {
+            _hbW.resize(idx + 1, 0.f);
+            _hbH.resize(idx + 1, 0.f);
+            _hbOX.resize(idx + 1, 0.f);
+            _hbOY.resize(idx + 1, 0.f);
+        }
+    };
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const EntityState &es = entities[i];
+
+        size_t idLocal;
+        auto it = _entityMap.find(es.entityId);
+        if (it == _entityMap.end())
+        {
+            idLocal = static_cast<size_t>(_registry.spawn_entity());
+            _entityMap[es.entityId] = idLocal;
+        }
+        else
+        {
+            idLocal = it->second;
+        }
+        auto &hudTags = _registry.get_components<component::hud_tag>();
+        auto &kindsLocal = _registry.get_components<component::entity_kind>();
 
-            if (!_activeEntities.empty())
+        if (idLocal < hudTags.size() && hudTags[idLocal].has_value())
+            continue;
+        if (idLocal < kindsLocal.size()
+            && kindsLocal[idLocal].has_value()
+            && kindsLocal[idLocal].value() == component::entity_kind::decor)
+            continue;
+        ensure_cache(idLocal);
+        newActive.insert(idLocal);
+
+        ensure_slot(positions, idLocal, component::position{});
+        ensure_slot(velocities, idLocal, component::velocity{});
+        ensure_slot(kinds, idLocal, component::entity_kind{});
+        ensure_slot(collisions, idLocal, component::collision_state{});
+        kinds[idLocal] = static_cast<component::entity_kind>(es.type);
+        ensure_slot(hitboxes, idLocal, component::hitbox{});
+        std::shared_ptr<R_Graphic::Texture> tex;
+        R_Graphic::textureRect rect;
+        component::animation anim;
+        switch (kinds[idLocal].value())
+        {
+        case component::entity_kind::playerProjectile:
+            anim = _playerData->projectileAnimation;
+            tex = _playerData->projectileTexture;
+            rect = _playerData->projectileRect;
+            ensure_slot(hitboxes, idLocal, component::hitbox{100, 24});
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
+            break;
+        case component::entity_kind::projectile_charged:
+            anim = _playerData->chargeProjectileAnimation;
+            tex = _playerData->chargeProjectileTexture;
+            rect = _playerData->chargeProjectileRect;
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
+            break;
+        case component::entity_kind::projectile_bomb:
+            anim = _playerData->missileProjectileAnimation;
+            tex = _playerData->missileProjectileTexture;
+            rect = _playerData->missileProjectileRect;
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
+            break;
+        case component::entity_kind::missile_explosion:
+            anim = _playerData->missileexplosionAnimation;
+            tex = _playerData->missileExplosionTexture;
+            rect = _playerData->missileexplosionRect;
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Effects});
+            break;
+        case component::entity_kind::player:
+            anim = _playerData->playerAnimation;
+            tex = _playerData->playerTexture;
+            rect = _playerData->playerRect;
+            ensure_slot(hitboxes, idLocal, component::hitbox{34, 20});
+            if (_playerIndexByLocalId.find(idLocal) == _playerIndexByLocalId.end())
+            {
+                int assigned = static_cast<int>((_playerIndexByLocalId.size() % 5) + 1);
+                _playerIndexByLocalId[idLocal] = assigned;
+            }
             {
-                for (auto id : _activeEntities)
+                const int playerIndex = _playerIndexByLocalId[idLocal];
+                const int rowOffset = (playerIndex - 1) * 17;
+                for (auto &kv : anim.clips)
                 {
-                    if (newActive.find(id) == newActive.end())
-                    {
-                        if (id == _player)
-                            continue;
-
-                        if (id < kinds.size() && kinds[id] &&
-                            kinds[id].value() == component::entity_kind::decor)
-                        {
-                            continue;
-                        }
-
-                        if (id < positions.size() && positions[id])
-                            positions[id].reset();
-                        if (id < velocities.size() && velocities[id])
-                            velocities[id].reset();
-                        if (id < drawables.size() && drawables[id])
-                            drawables[id].reset();
-                        if (id < kinds.size() && kinds[id])
-                            kinds[id].reset();
-                        if (id < collisions.size() && collisions[id])
-                            collisions[id].reset();
-                        if (id < _hbW.size())
-                        {
-                            _hbW[id] = 0.f;
-                            _hbH[id] = 0.f;
-                            _hbOX[id] = 0.f;
-                            _hbOY[id] = 0.f;
-                        }
-                    }
+                    kv.second.startY = rowOffset;
                 }
             }
-            _activeEntities = std::move(newActive);
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Players});
+            break;
+        case component::entity_kind::enemyProjectile:
+            anim = _enemyData->projectileAnimation;
+            tex = _enemyData->projectileTexture;
+            rect = _enemyData->projectileRect;
+            ensure_slot(hitboxes, idLocal, component::hitbox{60, 60});
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Projectiles});
+            break;
+        case component::entity_kind::enemy:
+        if (es.entityId % 3 == 0)
+            _enemyData->setType("boss");
+        else if (es.entityId % 2 == 0)
+            _enemyData->setType("shooter");
+        else
+            _enemyData->setType("crawler");
+            tex = _enemyData->enemyTexture;
+            rect = _enemyData->enemyRect;
+            ensure_slot(hitboxes, idLocal, component::hitbox{152, 100});
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Enemies});
+            break;
+        default:
+            tex = _playerData->playerTexture;
+            rect = _playerData->playerRect;
+            ensure_slot(drawables, idLocal, component::drawable{tex, rect, layers::Effects});
+            break;
+        }
+        ensure_slot(animations, idLocal, anim);
+
+        // The local ship is predicted and everything else interpolated, both in update()
+        if (es.entityId == _player)
+            _predictor.reconcile(inputTick, es.x, es.y);
+        else
+            _interpolator.push(idLocal, tick, es.x, es.y);
+        hitboxes[idLocal]->width = es.hb_w;
+        hitboxes[idLocal]->height = es.hb_h;
+        hitboxes[idLocal]->offset_x = es.hb_ox;
+        hitboxes[idLocal]->offset_y = es.hb_oy;
+        _hbW[idLocal] = es.hb_w;
+        _hbH[idLocal] = es.hb_h;
+        _hbOX[idLocal] = es.hb_ox;
+        _hbOY[idLocal] = es.hb_oy;
+        if (idLocal < kinds.size() && kinds[idLocal] &&
+            kinds[idLocal].value() == component::entity_kind::projectile_bomb)
+        {
+            ensure_slot(animations, idLocal, component::animation{});
+            auto &an = *animations[idLocal];
+            if (es.vy < 0.f)
+                setAnimation(an, "rotation", false);
+            else
+                setAnimation(an, "idle", false);
+        }
+        collisions[idLocal]->collided = (es.collided != 0);
+    }
+
+    // An id absent from the snapshot is dead or outside this client's interest area: kill its
+    // local entity and forget the mapping so the local index is recycled. If the server sends
+    // the same handle again later, it is spawned as a new local entity whose interpolation
+    // restarts from its first sample (the old track is forgotten here).
+    for (auto it = _entityMap.begin(); it != _entityMap.end();)
+    {
+        size_t id = it->second;
+        if (newActive.find(id) != newActive.end() || it->first == _player ||
+            (id < kinds.size() && kinds[id] &&
+             kinds[id].value() == component::entity_kind::decor))
+        {
+            ++it;
+            continue;
+        }
+        _registry.kill_entity(_registry.entity_from_index(id));
+        _interpolator.forget(id);
+        _playerIndexByLocalId.erase(id);
+        if (id < _hbW.size())
+        {
+            _hbW[id] = 0.f;
+            _hbH[id] = 0.f;
+            _hbOX[id] = 0.f;
+            _hbOY[id] = 0.f;
         }
+        it = _entityMap.erase(it);
     }
+    _activeEntities = std::move(newActive);
 }
 
 void R_Type::Rtype::draw()
@@ -569,6 +578,11 @@ void R_Type::Rtype::setServerEndpoint(const std::string &ip, unsigned short port
         engine::net::make_endpoint(ip, port));
 }
 
+void R_Type::Rtype::setInterpolationDelay(float ms)
+{
+    _interpolator.setDelay(ms);
+}
+
 void R_Type::Rtype::waiting_connection()
 {
     if (!_connected)
@@ -583,6 +597,9 @@ void R_Type::Rtype::waiting_connection()
                 std::memcpy(&ack, payload.data(), sizeof(ConnectAck));
                 _player = ack.playerEntityId;
                 _connected = true;
+                _interpolator.clear();
+                _predictor.reset();
+                _interpolator.setTickRate(ack.tickRate);
                 _registry.spawn_entity();
             }
         }
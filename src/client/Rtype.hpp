@@ -12,8 +12,13 @@
 #include "engine/renderer/App.hpp"
 #include "engine/events/Events.hpp"
 #include "engine/ecs/Registry.hpp"
+#include "engine/ecs/Collision.hpp"
+#include "common/SnapshotDelta.hpp"
+#include "common/Accessibility.hpp"
 #include "Background.hpp"
 #include "Gameover.hpp"
+#include "Interpolation.hpp"
+#include "Prediction.hpp"
 
 namespace Engine { namespace Profiling { class ProfilerOverlay; } }
 
@@ -55,6 +60,15 @@ namespace R_Type
          * @brief Receives and processes a snapshot from the server to synchronize game state.
          */
         void receiveSnapshot();
+
+        /**
+         * @brief Synchronizes the registry with a full list of entity states.
+         * @param tick Server tick the states were taken at.
+         * @param inputTick Last input of this client the server applied, or INPUT_NO_TICK.
+         * @param entities States of every entity present on the server this tick.
+         * @param n Number of states.
+         */
+        void applySnapshot(uint32_t tick, uint32_t inputTick, const EntityState *entities, size_t n);
         
         /**
          * @brief Renders the current game state to the application window.
@@ -76,6 +90,12 @@ namespace R_Type
     public:
         void setServerEndpoint(const std::string &ip, unsigned short port);
 
+        /**
+         * @brief Sets how far behind the newest snapshot remote entities are drawn.
+         * @param ms Delay in milliseconds; about two snapshot intervals hides one lost packet.
+         */
+        void setInterpolationDelay(float ms);
+
     private:
         /**
          * @brief Handles the waiting state during connection to the server.
@@ -97,17 +117,27 @@ namespace R_Type
         std::unique_ptr<engine::net::Endpoint> _serverEndpoint;
         uint32_t _tick = 0;
         std::unordered_set<engine::R_Events::Key> _pressedKeys;
+        InputBindings _inputBindings = InputBindings::fromConfig();
         uint32_t _player = 0;
         std::unordered_set<uint32_t> _activeEntities;
         engine::net::Endpoint _sender;
         engine::R_Graphic::App _app;
         engine::registry _registry;
+        engine::spatial_hash _broadphase;
+        engine::collision_matrix _collisionMatrix;
         std::unique_ptr<Background> _background;
         engine::net::IoContext _ioContext;
         std::unique_ptr<engine::net::UdpSocket> _client;
         std::unique_ptr<Player> _playerData;
         std::unique_ptr<Enemy> _enemyData;
         std::unordered_map<uint32_t, size_t> _entityMap;
+        // Reconstructed snapshots, baselines for the server's deltas
+        snapshot::History _snapshotHistory;
+        uint32_t _lastSnapshotSequence = SNAPSHOT_NO_BASELINE;
+        // Server positions of remote entities, drawn a delay behind the newest snapshot
+        SnapshotInterpolator _interpolator;
+        // Local ship moved by its own inputs ahead of the server, reconciled on each snapshot
+        PlayerPredictor _predictor;
         std::unique_ptr<Hud> _hud;
         std::vector<float> _hbW, _hbH, _hbOX, _hbOY;
         std::unique_ptr<R_Type::Menu> _menu;
@@ -1,4 +1,5 @@
 #include "common/Accessibility.hpp"
+#include "common/Packets.hpp"
 #include "engine/events/Events.hpp"
 #include <fstream>
 #include <iostream>
@@ -88,4 +89,46 @@ engine::R_Events::Key stringToKey(const std::string &name)
     if (n == "LSHIFT") return engine::R_Events::Key::LShift;
 
     return engine::R_Events::Key::Unknown;
-}
\ No newline at end of file
+}
+
+InputBindings InputBindings::fromConfig()
+{
+    using engine::R_Events::Key;
+    InputBindings b;
+    for (Key k : {Key::Left, Key::Q, Key::ControllerLeftJoystickLeft}) b.bind(k, INPUT_LEFT);
+    for (Key k : {Key::Right, Key::D, Key::ControllerLeftJoystickRight}) b.bind(k, INPUT_RIGHT);
+    for (Key k : {Key::Up, Key::Z, Key::ControllerLeftJoystickUp}) b.bind(k, INPUT_UP);
+    for (Key k : {Key::Down, Key::S, Key::ControllerLeftJoystickDown}) b.bind(k, INPUT_DOWN);
+    b.bind(Key::Space, INPUT_FIRE);
+    b.bind(Key::C, INPUT_BOMB);
+
+    // Config names, English ones from the settings file and the French built-in defaults
+    static const std::pair<const char *, uint8_t> names[] = {
+        {"move_left", INPUT_LEFT}, {"move_right", INPUT_RIGHT},
+        {"move_up", INPUT_UP}, {"move_down", INPUT_DOWN},
+        {"shoot", INPUT_FIRE}, {"tir", INPUT_FIRE},
+        {"special", INPUT_BOMB}, {"tir_alternatif", INPUT_BOMB}};
+    for (auto &[name, action] : names) {
+        auto it = AccessibilityConfig::key_remap.find(name);
+        if (it == AccessibilityConfig::key_remap.end())
+            continue;
+        Key key = stringToKey(it->second);
+        if (key != Key::Unknown)
+            b.bind(key, action);
+    }
+    return b;
+}
+
+uint8_t InputBindings::actions(const std::unordered_set<engine::R_Events::Key> &pressed) const
+{
+    uint8_t bits = 0;
+    for (auto &[key, action] : _bindings)
+        if (pressed.count(key))
+            bits |= action;
+    return bits;
+}
+
+void InputBindings::bind(engine::R_Events::Key key, uint8_t action)
+{
+    _bindings.emplace_back(key, action);
+}
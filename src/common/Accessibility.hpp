@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "engine/events/Events.hpp"
 
@@ -24,3 +28,18 @@ struct AccessibilityConfig {
     static void load_from_json(const std::string &path);
 };
 engine::R_Events::Key stringToKey(const std::string &keyName);
+
+// Keys bound to each InputAction: the default controls (arrows, ZQSD, left stick, Space,
+// C) plus the keys set in AccessibilityConfig::key_remap, which add to the defaults.
+class InputBindings {
+public:
+    static InputBindings fromConfig();
+
+    // InputAction bits of the actions whose keys are held
+    uint8_t actions(const std::unordered_set<engine::R_Events::Key> &pressed) const;
+
+private:
+    void bind(engine::R_Events::Key key, uint8_t action);
+
+    std::vector<std::pair<engine::R_Events::Key, uint8_t>> _bindings;
+};
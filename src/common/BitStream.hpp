@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+/**    * @file BitStream.hpp
+    * @brief Bit-level writer and reader for packed packet payloads.
+    *
+    * Values are stored least significant bit first, back to back across byte boundaries, so a
+    * 15-bit coordinate costs 15 bits. Varints store 7 bits per byte-sized group with the high
+    * bit set while more groups follow: small numbers (id gaps, counts) take one group.
+    */
+
+/**    * @brief Appends bits to a byte buffer (which may already hold a header).
+    */
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : _out(out) {}
+
+    // Low `count` bits of `value`, count <= 32
+    void write(uint32_t value, unsigned count)
+    {
+        _scratch |= (static_cast<uint64_t>(value) & low_bits(count)) << _bits;
+        _bits += count;
+        while (_bits >= 8) {
+            _out.push_back(static_cast<uint8_t>(_scratch));
+            _scratch >>= 8;
+            _bits -= 8;
+        }
+    }
+
+    void write_bool(bool value) { write(value ? 1u : 0u, 1); }
+
+    void write_varint(uint32_t value)
+    {
+        while (value >= 0x80) {
+            write((value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        write(value, 8);
+    }
+
+    // Pads the last partial byte with zeros; call once all values are written
+    void flush()
+    {
+        if (_bits > 0) {
+            _out.push_back(static_cast<uint8_t>(_scratch));
+            _scratch = 0;
+            _bits = 0;
+        }
+    }
+
+private:
+    static uint64_t low_bits(unsigned count) { return (uint64_t{1} << count) - 1; }
+
+    std::vector<uint8_t> &_out;
+    uint64_t _scratch = 0; // bits not yet stored, lowest first
+    unsigned _bits = 0;
+};
+
+/**    * @brief Reads values written by BitWriter, with bounds checking.
+    *
+    * Reading past the end returns zeros and marks the reader as failed: decoders check ok()
+    * once at the end instead of after every field.
+    */
+class BitReader
+{
+public:
+    BitReader(const uint8_t *data, std::size_t size) : _data(data), _size(size) {}
+
+    uint32_t read(unsigned count)
+    {
+        while (_bits < count) {
+            if (_pos == _size) {
+                _failed = true;
+                return 0;
+            }
+            _scratch |= static_cast<uint64_t>(_data[_pos++]) << _bits;
+            _bits += 8;
+        }
+        const auto value = static_cast<uint32_t>(_scratch & ((uint64_t{1} << count) - 1));
+        _scratch >>= count;
+        _bits -= count;
+        return value;
+    }
+
+    bool read_bool() { return read(1) != 0; }
+
+    uint32_t read_varint()
+    {
+        uint32_t value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7) {
+            const uint32_t group = read(8);
+            value |= (group & 0x7F) << shift;
+            if (!(group & 0x80))
+                return value;
+        }
+        _failed = true; // more than 5 groups: not a 32-bit varint
+        return 0;
+    }
+
+    bool ok() const { return !_failed; }
+
+private:
+    const uint8_t *_data;
+    std::size_t _size;
+    std::size_t _pos = 0;
+    uint64_t _scratch = 0;
+    unsigned _bits = 0;
+    bool _failed = false;
+};
@@ -28,7 +28,16 @@ enum PacketType : uint16_t
     GAME_OVER = 8,
     LEVEL_START = 9,
     LEVEL_END = 10, 
+    SNAPSHOT_DELTA = 11,
+    FRAGMENT = 12,
 };
+
+/**    * @brief Sequence value meaning "no snapshot" (nothing acknowledged yet / full snapshot).
+    */
+constexpr uint32_t SNAPSHOT_NO_BASELINE = 0xFFFFFFFFu;
+/**    * @brief Tick value meaning "none yet" (no input applied, no snapshot drawn).
+    */
+constexpr uint32_t INPUT_NO_TICK = 0xFFFFFFFFu;
 /**    * @brief Connect request packet structure.
     */  
 struct ConnectReq
@@ -41,21 +50,37 @@ struct ConnectAck
 {
     uint32_t serverId;
     uint32_t tickRate;
-    uint16_t playerEntityId;
+    uint32_t playerEntityId;
 };
-/**    * @brief Input packet structure.
+/**    * @brief Actions a player can hold, as bits of InputPacket::actions.
+    *
+    * The client maps its keys to actions (see InputBindings in Accessibility.hpp), so the
+    * server never sees keycodes.
+    */
+enum InputAction : uint8_t
+{
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_UP = 1 << 2,
+    INPUT_DOWN = 1 << 3,
+    INPUT_FIRE = 1 << 4, // basic shot on release, charged when held long enough
+    INPUT_BOMB = 1 << 5,
+};
+/**    * @brief Input packet structure (fixed size, sent every client frame).
     */  
 struct InputPacket
 {
     uint32_t clientId;
     uint32_t tick;
-    uint16_t keyCount;
+    uint32_t ackSequence; // last SNAPSHOT_DELTA sequence received, or SNAPSHOT_NO_BASELINE
+    uint32_t viewTick;    // server tick remote entities are drawn at, or INPUT_NO_TICK
+    uint8_t actions;      // InputAction bits held this frame
 };
 /**    * @brief State of a single entity in a snapshot.
     */  
 struct EntityState
 {
-    uint32_t entityId;
+    uint32_t entityId; // generational handle: index in the low 20 bits, generation above
     float x, y;
     float vx, vy;
     uint8_t type;
@@ -75,6 +100,36 @@ struct Snapshot
     uint16_t entityCount;
     // followed by `EntityState[entityCount]`
 };
+/**    * @brief Delta snapshot packet structure.
+    *
+    * Encodes the world at `tick` against the snapshot `baseSequence` the client acknowledged
+    * (SNAPSHOT_NO_BASELINE: every entity is sent in full). See common/SnapshotDelta.hpp.
+    */
+struct DeltaSnapshot
+{
+    uint32_t tick;
+    uint32_t sequence;
+    uint32_t baseSequence;
+    uint32_t inputTick;    // last InputPacket::tick of this client applied, or INPUT_NO_TICK
+    uint16_t entityCount;  // changed or new entities
+    uint16_t removedCount; // entities of the baseline no longer present
+    // followed by `entityCount` x (uint32 entityId, uint8 field mask, present fields)
+    // then `removedCount` x uint32 entityId
+};
+/**    * @brief Fragment packet structure.
+    *
+    * Messages that do not fit in one datagram are split by engine::net::UdpSocket into
+    * `count` fragments carrying consecutive byte ranges of the original payload.
+    */
+struct FragmentHeader
+{
+    uint16_t messageId; // per-sender message counter
+    uint16_t index;     // fragment number, payload offset = index * fragment payload size
+    uint16_t count;     // fragments in the message
+    uint8_t innerType;  // PacketType of the reassembled message
+    uint32_t totalSize; // reassembled payload size
+    // followed by the fragment bytes
+};
 /**    * @brief Event packet structure.
     */  
 struct EventPacket
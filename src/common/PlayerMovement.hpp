@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "engine/ecs/Components.hpp"
+#include "common/Packets.hpp"
+#include "common/Accessibility.hpp"
+
+#define PLAYER_SPEED 400.0f
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+
+/**
+ * @file PlayerMovement.hpp
+ * @brief Movement rules of a player ship, shared by the server simulation and client prediction.
+ *
+ * The server turns each INPUT into a velocity and keeps ships inside the screen (bounds
+ * system). The client predicts its own ship with the same functions, so a prediction only
+ * drifts from the server by timing, never by rules.
+ */
+
+// Scale applied to simulated time (accessibility "speed_game"): the server moves entities by
+// tick dt times this factor, and the client records its inputs with the same scaled dt
+inline float game_speed_factor()
+{
+    return AccessibilityConfig::enabled ? AccessibilityConfig::speed_game : 1.0f;
+}
+
+// Velocity of a ship whose InputAction bits are `actions` (left/up win over right/down)
+inline component::velocity player_velocity(uint8_t actions)
+{
+    return component::velocity{
+        (actions & INPUT_LEFT) ? -PLAYER_SPEED : (actions & INPUT_RIGHT) ? PLAYER_SPEED : 0.f,
+        (actions & INPUT_UP) ? -PLAYER_SPEED : (actions & INPUT_DOWN) ? PLAYER_SPEED : 0.f};
+}
+
+// Clamps a ship position to the screen; true if it was outside
+inline bool clamp_player_position(component::position &pos)
+{
+    bool corrected = false;
+    if (pos.x < 0.f) { pos.x = 0.f; corrected = true; }
+    else if (pos.x > SCREEN_WIDTH) { pos.x = SCREEN_WIDTH; corrected = true; }
+    if (pos.y < 0.f) { pos.y = 0.f; corrected = true; }
+    else if (pos.y > SCREEN_HEIGHT) { pos.y = SCREEN_HEIGHT; corrected = true; }
+    return corrected;
+}
@@ -0,0 +1,322 @@
+#include "common/SnapshotDelta.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "common/BitStream.hpp"
+
+namespace
+{
+    bool same_bits(const void *a, const void *b, std::size_t n)
+    {
+        return std::memcmp(a, b, n) == 0;
+    }
+
+    bool by_id(const EntityState &a, const EntityState &b)
+    {
+        return a.entityId < b.entityId;
+    }
+
+    // Signed fields are stored with an offset: their origin is half their range below zero
+    constexpr float VELOCITY_ORIGIN = -static_cast<float>(1u << (snapshot::VELOCITY_BITS - 1)) / snapshot::VELOCITY_STEPS;
+    constexpr float HITBOX_ORIGIN = -static_cast<float>(1u << (snapshot::HITBOX_BITS - 1)) / snapshot::HITBOX_STEPS;
+    constexpr unsigned SPAWN_BITS = 2 * snapshot::POSITION_BITS + 2 * snapshot::VELOCITY_BITS + 8 + 8 + 1 +
+                                    4 * snapshot::HITBOX_BITS;
+
+    // Fields an update entry can carry, in wire order; type and hitbox changes respawn instead
+    enum UpdateField : uint32_t
+    {
+        UPDATE_X = 1 << 0,
+        UPDATE_Y = 1 << 1,
+        UPDATE_VX = 1 << 2,
+        UPDATE_VY = 1 << 3,
+        UPDATE_HP = 1 << 4,
+        UPDATE_COLLIDED = 1 << 5,
+    };
+    constexpr unsigned UPDATE_MASK_BITS = 6;
+
+    bool is_spawn(uint8_t mask)
+    {
+        return (mask & (snapshot::FIELD_TYPE | snapshot::FIELD_HITBOX)) != 0;
+    }
+
+    uint32_t to_update_mask(uint8_t mask)
+    {
+        uint32_t update = 0;
+        if (mask & snapshot::FIELD_X) update |= UPDATE_X;
+        if (mask & snapshot::FIELD_Y) update |= UPDATE_Y;
+        if (mask & snapshot::FIELD_VX) update |= UPDATE_VX;
+        if (mask & snapshot::FIELD_VY) update |= UPDATE_VY;
+        if (mask & snapshot::FIELD_HP) update |= UPDATE_HP;
+        if (mask & snapshot::FIELD_COLLIDED) update |= UPDATE_COLLIDED;
+        return update;
+    }
+
+    uint32_t to_steps(float value, float origin, float steps, unsigned bits)
+    {
+        const float scaled = std::round((value - origin) * steps);
+        const auto top = static_cast<float>((1u << bits) - 1);
+        if (!(scaled > 0.f)) // also catches NaN
+            return 0;
+        return static_cast<uint32_t>(std::min(scaled, top));
+    }
+
+    float from_steps(uint32_t value, float origin, float steps)
+    {
+        return origin + static_cast<float>(value) / steps;
+    }
+
+    void write_position(BitWriter &bits, float v)
+    {
+        bits.write(to_steps(v, snapshot::POSITION_ORIGIN, snapshot::POSITION_STEPS, snapshot::POSITION_BITS), snapshot::POSITION_BITS);
+    }
+    void write_velocity(BitWriter &bits, float v)
+    {
+        bits.write(to_steps(v, VELOCITY_ORIGIN, snapshot::VELOCITY_STEPS, snapshot::VELOCITY_BITS), snapshot::VELOCITY_BITS);
+    }
+    void write_hitbox(BitWriter &bits, float v)
+    {
+        bits.write(to_steps(v, HITBOX_ORIGIN, snapshot::HITBOX_STEPS, snapshot::HITBOX_BITS), snapshot::HITBOX_BITS);
+    }
+
+    float read_position(BitReader &bits)
+    {
+        return from_steps(bits.read(snapshot::POSITION_BITS), snapshot::POSITION_ORIGIN, snapshot::POSITION_STEPS);
+    }
+    float read_velocity(BitReader &bits)
+    {
+        return from_steps(bits.read(snapshot::VELOCITY_BITS), VELOCITY_ORIGIN, snapshot::VELOCITY_STEPS);
+    }
+    float read_hitbox(BitReader &bits)
+    {
+        return from_steps(bits.read(snapshot::HITBOX_BITS), HITBOX_ORIGIN, snapshot::HITBOX_STEPS);
+    }
+}
+
+namespace snapshot
+{
+    void History::push(uint32_t sequence, StatesPtr states)
+    {
+        Entry &e = _entries[sequence % CAPACITY];
+        e.sequence = sequence;
+        e.states = std::move(states);
+    }
+
+    StatesPtr History::find(uint32_t sequence) const
+    {
+        if (sequence == SNAPSHOT_NO_BASELINE)
+            return nullptr;
+        const Entry &e = _entries[sequence % CAPACITY];
+        return e.sequence == sequence ? e.states : nullptr;
+    }
+
+    void History::clear()
+    {
+        _entries.fill(Entry{});
+    }
+
+    uint8_t diff_fields(const EntityState &base, const EntityState &cur)
+    {
+        uint8_t mask = 0;
+        if (!same_bits(&base.x, &cur.x, sizeof(cur.x))) mask |= FIELD_X;
+        if (!same_bits(&base.y, &cur.y, sizeof(cur.y))) mask |= FIELD_Y;
+        if (!same_bits(&base.vx, &cur.vx, sizeof(cur.vx))) mask |= FIELD_VX;
+        if (!same_bits(&base.vy, &cur.vy, sizeof(cur.vy))) mask |= FIELD_VY;
+        if (base.type != cur.type) mask |= FIELD_TYPE;
+        if (base.hp != cur.hp) mask |= FIELD_HP;
+        if (base.collided != cur.collided) mask |= FIELD_COLLIDED;
+        if (!same_bits(&base.hb_w, &cur.hb_w, sizeof(float) * 4)) mask |= FIELD_HITBOX;
+        return mask;
+    }
+
+    void quantize(EntityState &es)
+    {
+        es.x = from_steps(to_steps(es.x, POSITION_ORIGIN, POSITION_STEPS, POSITION_BITS), POSITION_ORIGIN, POSITION_STEPS);
+        es.y = from_steps(to_steps(es.y, POSITION_ORIGIN, POSITION_STEPS, POSITION_BITS), POSITION_ORIGIN, POSITION_STEPS);
+        es.vx = from_steps(to_steps(es.vx, VELOCITY_ORIGIN, VELOCITY_STEPS, VELOCITY_BITS), VELOCITY_ORIGIN, VELOCITY_STEPS);
+        es.vy = from_steps(to_steps(es.vy, VELOCITY_ORIGIN, VELOCITY_STEPS, VELOCITY_BITS), VELOCITY_ORIGIN, VELOCITY_STEPS);
+        for (float *hb : {&es.hb_w, &es.hb_h, &es.hb_ox, &es.hb_oy})
+            *hb = from_steps(to_steps(*hb, HITBOX_ORIGIN, HITBOX_STEPS, HITBOX_BITS), HITBOX_ORIGIN, HITBOX_STEPS);
+    }
+
+    std::size_t id_gap_bits(uint32_t gap)
+    {
+        std::size_t bits = 8;
+        for (; gap >= 0x80; gap >>= 7)
+            bits += 8;
+        return bits;
+    }
+
+    std::size_t entry_bits(uint8_t mask, uint32_t idGap)
+    {
+        std::size_t bits = id_gap_bits(idGap) + 1; // spawn flag
+        if (is_spawn(mask)) {
+            bits += SPAWN_BITS;
+        } else {
+            bits += UPDATE_MASK_BITS;
+            if (mask & FIELD_X) bits += POSITION_BITS;
+            if (mask & FIELD_Y) bits += POSITION_BITS;
+            if (mask & FIELD_VX) bits += VELOCITY_BITS;
+            if (mask & FIELD_VY) bits += VELOCITY_BITS;
+            if (mask & FIELD_HP) bits += 8;
+            if (mask & FIELD_COLLIDED) bits += 1;
+        }
+        return bits;
+    }
+
+    void write_delta(DeltaSnapshot hdr, const States &current, const States *baseline,
+                     std::vector<uint8_t> &out)
+    {
+        out.clear();
+        out.resize(sizeof(DeltaSnapshot));
+        if (!baseline)
+            hdr.baseSequence = SNAPSHOT_NO_BASELINE;
+        BitWriter bits(out);
+
+        // Both lists are sorted by entityId: walk them together
+        static const States empty;
+        const States &base = baseline ? *baseline : empty;
+        uint16_t changed = 0;
+        uint32_t prevId = 0;
+        std::size_t b = 0;
+        for (const EntityState &cur : current) {
+            while (b < base.size() && base[b].entityId < cur.entityId)
+                ++b;
+            uint8_t mask = FIELD_ALL;
+            if (b < base.size() && base[b].entityId == cur.entityId)
+                mask = diff_fields(base[b++], cur);
+            if (mask == 0)
+                continue;
+            bits.write_varint(cur.entityId - prevId);
+            prevId = cur.entityId;
+            if (is_spawn(mask)) {
+                bits.write_bool(true);
+                write_position(bits, cur.x);
+                write_position(bits, cur.y);
+                write_velocity(bits, cur.vx);
+                write_velocity(bits, cur.vy);
+                bits.write(cur.type, 8);
+                bits.write(cur.hp, 8);
+                bits.write_bool(cur.collided);
+                write_hitbox(bits, cur.hb_w);
+                write_hitbox(bits, cur.hb_h);
+                write_hitbox(bits, cur.hb_ox);
+                write_hitbox(bits, cur.hb_oy);
+            } else {
+                bits.write_bool(false);
+                bits.write(to_update_mask(mask), UPDATE_MASK_BITS);
+                if (mask & FIELD_X) write_position(bits, cur.x);
+                if (mask & FIELD_Y) write_position(bits, cur.y);
+                if (mask & FIELD_VX) write_velocity(bits, cur.vx);
+                if (mask & FIELD_VY) write_velocity(bits, cur.vy);
+                if (mask & FIELD_HP) bits.write(cur.hp, 8);
+                if (mask & FIELD_COLLIDED) bits.write_bool(cur.collided);
+            }
+            ++changed;
+        }
+
+        // Removed ids follow the entries: a second walk emits them in place instead of
+        // collecting them in a temporary list (this runs for every client every tick)
+        uint16_t removed = 0;
+        prevId = 0;
+        std::size_t c = 0;
+        for (const EntityState &old : base) {
+            while (c < current.size() && current[c].entityId < old.entityId)
+                ++c;
+            if (c < current.size() && current[c].entityId == old.entityId)
+                continue;
+            bits.write_varint(old.entityId - prevId);
+            prevId = old.entityId;
+            ++removed;
+        }
+        bits.flush();
+
+        hdr.entityCount = changed;
+        hdr.removedCount = removed;
+        std::memcpy(out.data(), &hdr, sizeof(DeltaSnapshot));
+    }
+
+    bool read_delta(const uint8_t *data, std::size_t size, const History &history,
+                    DeltaSnapshot &hdr, States &out)
+    {
+        if (size < sizeof(DeltaSnapshot))
+            return false;
+        std::memcpy(&hdr, data, sizeof(DeltaSnapshot));
+        BitReader bits(data + sizeof(DeltaSnapshot), size - sizeof(DeltaSnapshot));
+
+        StatesPtr baseline;
+        if (hdr.baseSequence != SNAPSHOT_NO_BASELINE) {
+            baseline = history.find(hdr.baseSequence);
+            if (!baseline)
+                return false;
+            out = *baseline;
+        } else {
+            out.clear();
+        }
+        const std::size_t baseCount = out.size();
+
+        uint32_t id = 0;
+        for (uint16_t i = 0; i < hdr.entityCount; ++i) {
+            id += bits.read_varint();
+            EntityState key{};
+            key.entityId = id;
+            auto baseEnd = out.begin() + baseCount;
+            auto it = std::lower_bound(out.begin(), baseEnd, key, by_id);
+            const bool known = it != baseEnd && it->entityId == id;
+            if (bits.read_bool()) {
+                EntityState es = key;
+                es.x = read_position(bits);
+                es.y = read_position(bits);
+                es.vx = read_velocity(bits);
+                es.vy = read_velocity(bits);
+                es.type = static_cast<uint8_t>(bits.read(8));
+                es.hp = static_cast<uint8_t>(bits.read(8));
+                es.collided = bits.read_bool();
+                es.hb_w = read_hitbox(bits);
+                es.hb_h = read_hitbox(bits);
+                es.hb_ox = read_hitbox(bits);
+                es.hb_oy = read_hitbox(bits);
+                if (known)
+                    *it = es;
+                else
+                    out.push_back(es);
+                continue;
+            }
+            // Updates only apply to entities the baseline has
+            if (!known)
+                return false;
+            const uint32_t mask = bits.read(UPDATE_MASK_BITS);
+            if (mask & UPDATE_X) it->x = read_position(bits);
+            if (mask & UPDATE_Y) it->y = read_position(bits);
+            if (mask & UPDATE_VX) it->vx = read_velocity(bits);
+            if (mask & UPDATE_VY) it->vy = read_velocity(bits);
+            if (mask & UPDATE_HP) it->hp = static_cast<uint8_t>(bits.read(8));
+            if (mask & UPDATE_COLLIDED) it->collided = bits.read_bool();
+        }
+
+        // Removed ids come in increasing order, as does the baseline part of `out`
+        if (hdr.removedCount > 0) {
+            auto keep = out.begin();
+            auto baseEnd = out.begin() + baseCount;
+            id = 0;
+            uint32_t nextRemoved = (id += bits.read_varint());
+            uint16_t left = hdr.removedCount;
+            for (auto it = out.begin(); it != out.end(); ++it) {
+                if (left > 0 && it < baseEnd && it->entityId == nextRemoved) {
+                    if (--left > 0)
+                        nextRemoved = (id += bits.read_varint());
+                    continue;
+                }
+                if (left > 0 && it < baseEnd && it->entityId > nextRemoved)
+                    return false; // removal of an id the baseline does not have
+                *keep++ = *it;
+            }
+            if (left > 0)
+                return false;
+            out.erase(keep, out.end());
+        }
+        if (!bits.ok())
+            return false;
+        std::sort(out.begin(), out.end(), by_id);
+        return true;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "common/Packets.hpp"
+/**    * @file SnapshotDelta.hpp
+    * @brief Field-level delta encoding of snapshots against an acknowledged baseline.
+    *
+    * Both sides keep the last History::CAPACITY snapshots they exchanged, keyed by sequence.
+    * The server encodes each new snapshot against the one the client last acknowledged
+    * (InputPacket::ackSequence): unchanged entities are omitted, changed ones only carry the
+    * fields that differ, and entities gone since the baseline are listed by id. The client
+    * rebuilds the full state from its own copy of the baseline.
+    *
+    * The body after the DeltaSnapshot header is bit-packed (see BitStream.hpp). Ids are varint
+    * gaps from the previous id. An entity new to the client (or whose type or hitbox changed)
+    * is a spawn entry carrying every field. Other entries carry a 6-bit mask and only the
+    * motion, hp and collision fields that changed. Positions travel as 1/8 px steps, velocities
+    * as 1/16 unit steps and hitboxes as 1/8 px steps. The server quantizes states before
+    * storing them, so both sides diff the exact same values.
+    */
+namespace snapshot
+{
+    // Field mask bits of one delta entry, in wire order
+    enum Field : uint8_t
+    {
+        FIELD_X = 1 << 0,
+        FIELD_Y = 1 << 1,
+        FIELD_VX = 1 << 2,
+        FIELD_VY = 1 << 3,
+        FIELD_TYPE = 1 << 4,
+        FIELD_HP = 1 << 5,
+        FIELD_COLLIDED = 1 << 6,
+        FIELD_HITBOX = 1 << 7, // hb_w, hb_h, hb_ox, hb_oy
+        FIELD_ALL = 0xFF,
+    };
+
+    // Wire resolution of the quantized EntityState fields
+    constexpr float POSITION_STEPS = 8.f;     // per pixel
+    constexpr float POSITION_ORIGIN = -1024.f; // POSITION_BITS cover [-1024, 3072) on both axes
+    constexpr unsigned POSITION_BITS = 15;
+    constexpr float VELOCITY_STEPS = 16.f;    // per unit, signed
+    constexpr unsigned VELOCITY_BITS = 16;
+    constexpr float HITBOX_STEPS = 8.f;       // per pixel, signed
+    constexpr unsigned HITBOX_BITS = 16;
+
+    // Entity states of one snapshot, sorted by entityId
+    using States = std::vector<EntityState>;
+    using StatesPtr = std::shared_ptr<const States>;
+
+    /**    * @brief Ring of the last snapshots sent or received, looked up by sequence.
+        */
+    class History
+    {
+    public:
+        static constexpr std::size_t CAPACITY = 32;
+
+        void push(uint32_t sequence, StatesPtr states);
+        StatesPtr find(uint32_t sequence) const;
+        void clear();
+
+    private:
+        struct Entry
+        {
+            uint32_t sequence = SNAPSHOT_NO_BASELINE;
+            StatesPtr states;
+        };
+        std::array<Entry, CAPACITY> _entries{};
+    };
+
+    /**    * @brief Returns the mask of fields that differ between two states (bitwise compare).
+        */
+    uint8_t diff_fields(const EntityState &base, const EntityState &cur);
+
+    /**    * @brief Rounds the fields of `es` to their wire resolution (clamping out-of-range values).
+        *
+        * Idempotent: a quantized state encodes and decodes to itself.
+        */
+    void quantize(EntityState &es);
+
+    /**    * @brief Returns the encoded size in bits of the varint gap between two listed ids.
+        */
+    std::size_t id_gap_bits(uint32_t gap);
+
+    /**    * @brief Returns the encoded size in bits of a delta entry for a diff_fields() mask.
+        * @param idGap Gap from the id of the previous entry (from 0 for the first one).
+        *
+        * Exact: entries are bit-packed back to back, only the end of the body is padded.
+        */
+    std::size_t entry_bits(uint8_t mask, uint32_t idGap);
+
+    /**    * @brief Encodes a DeltaSnapshot payload into `out` (cleared first).
+        * @param baseline States of `hdr.baseSequence`, or nullptr to send every entity in full.
+        */
+    void write_delta(DeltaSnapshot hdr, const States &current, const States *baseline,
+                     std::vector<uint8_t> &out);
+
+    /**    * @brief Decodes a DeltaSnapshot payload, resolving its baseline in `history`.
+        * @return false if the payload is truncated or its baseline is unknown.
+        */
+    bool read_delta(const uint8_t *data, std::size_t size, const History &history,
+                    DeltaSnapshot &hdr, States &out);
+}
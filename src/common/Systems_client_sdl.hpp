@@ -46,7 +46,7 @@
 using namespace engine;
 
 inline void control_system(registry &r,
-    sparse_array<component::velocity> &velocities,
+    storage_t<component::velocity> &velocities,
     sparse_array<component::controllable> &controls)
 {
     for (auto &&[i, vel, c] : indexed_zipper(velocities, controls))
@@ -57,7 +57,7 @@ inline void control_system(registry &r,
 }
 
 inline void draw_system(registry &r,
-                        sparse_array<component::position> &positions,
+                        storage_t<component::position> &positions,
                         sparse_array<component::drawable> &drawables,
                         R_Graphic::Window &window)
 {
@@ -88,9 +88,9 @@ inline void draw_system(registry &r,
     }
 }
 
-inline void hitbox_overlay_system(registry &r, sparse_array<component::position> &positions,
+inline void hitbox_overlay_system(registry &r, storage_t<component::position> &positions,
     sparse_array<component::hitbox> &hitboxes,
-    sparse_array<component::entity_kind> &kinds,
+    storage_t<component::entity_kind> &kinds,
     R_Graphic::Window &window,
     int thickness = 2)
 {
@@ -153,8 +153,8 @@ inline void lifetime_system(registry &r, float dt)
 }
 
 inline void scroll_reset_system(engine::registry &r,
-                                engine::sparse_array<component::position> &positions,
-                                engine::sparse_array<component::entity_kind> &kinds,
+                                engine::storage_t<component::position> &positions,
+                                engine::storage_t<component::entity_kind> &kinds,
                                 R_Graphic::App &app)
 {
     int width = app.getWindow().getSize().x;
@@ -186,7 +186,7 @@ inline void scroll_reset_system(engine::registry &r,
 
 // Animation system for updating sprite animations
 inline void animation_system(registry &r,
-                             sparse_array<component::animation> &animations,
+                             sparse_set<component::animation> &animations,
                              sparse_array<component::drawable> &drawables,
                              float deltaTime)
 {
@@ -2,11 +2,23 @@
 
 // Core engine headers (always available)
 #include "engine/ecs/Entity.hpp"
+#include "engine/ecs/EntitySet.hpp"
+#include "engine/ecs/ComponentId.hpp"
+#include "engine/ecs/Archetype.hpp"
+#include "engine/ecs/CommandBuffer.hpp"
+#include "engine/ecs/MembershipLog.hpp"
+#include "engine/ecs/View.hpp"
 #include "engine/ecs/Registry.hpp"
 #include "engine/ecs/Sparse_array.hpp"
+#include "engine/ecs/Sparse_set.hpp"
+#include "engine/ecs/Storage.hpp"
 #include "engine/ecs/EntityFactory.hpp"
 #include "engine/ecs/Components.hpp"
 #include "engine/ecs/Systems.hpp"
+#include "engine/ecs/SimdKernels.hpp"
+#include "engine/threading/ThreadPool.hpp"
+#include "engine/threading/SpscQueue.hpp"
+#include "engine/memory/BumpArena.hpp"
 
 // Subsystem includes
 #include "engine/renderer/App.hpp"
@@ -21,6 +33,7 @@
 #include "engine/network/Endpoint.hpp"
 #include "engine/events/Events.hpp"
 #include "engine/profiling/Profiler.hpp"
+#include "engine/profiling/AllocationCounter.hpp"
 #include "engine/profiling/ProfilerOverlay.hpp"
 
 namespace Engine {
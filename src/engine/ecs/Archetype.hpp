@@ -0,0 +1,516 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ComponentId.hpp"
+#include "MembershipLog.hpp"
+/**
+ * @file Archetype.hpp
+ * @brief Defines engine::archetype_table, chunked struct-of-arrays storage grouped by component set,
+ *        and engine::archetype_column, the per-component view registry code uses to access it.
+ *
+ * Entities holding exactly the same set of archetype-stored components share an archetype. An
+ * archetype keeps its entities in fixed-capacity chunks; a chunk has one contiguous column per
+ * component plus the entity index of each row. Queries (for_each_chunk) hand whole columns to
+ * the caller, so joins over those components become plain array loops without per-index
+ * presence checks.
+ *
+ * Adding or removing an archetype component moves the entity's row to another archetype; the
+ * hole is filled with the archetype's last row. Appending never moves existing rows (chunk
+ * columns are reserved at full capacity).
+ *
+ * @note References to archetype components stay valid until a component is added to or removed
+ *       from an entity of the same archetype; collect entities first and apply such changes
+ *       after the loop, as with sparse_set.
+ */
+namespace engine
+{
+    class archetype_table
+    {
+    public:
+        static constexpr std::size_t chunk_capacity = 256;
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        archetype_table() = default;
+        archetype_table(archetype_table const &) = delete;
+        archetype_table &operator=(archetype_table const &) = delete;
+
+        // Makes Component known so that archetypes containing it can create its columns
+        template <class Component>
+        void register_column()
+        {
+            component_id_t id = component_id<Component>();
+            if (id >= _prototypes.size())
+                _prototypes.resize(id + 1);
+            if (!_prototypes[id])
+                _prototypes[id] = std::make_unique<column<Component>>();
+        }
+
+        template <class Component>
+        Component *find(std::size_t entity) noexcept
+        {
+            return const_cast<Component *>(std::as_const(*this).find<Component>(entity));
+        }
+
+        template <class Component>
+        Component const *find(std::size_t entity) const noexcept
+        {
+            if (entity >= _locations.size() || _locations[entity].archetype == npos)
+                return nullptr;
+            location const &loc = _locations[entity];
+            archetype const &arch = _archetypes[loc.archetype];
+            std::size_t col = arch.column_index(component_id<Component>());
+            if (col == npos)
+                return nullptr;
+            return &data<Component>(*arch.chunks[loc.chunk].columns[col])[loc.row];
+        }
+
+        // Sets the entity's Component, moving it to the matching archetype when it had none
+        template <class Component, class Value>
+        Component &insert(std::size_t entity, Value &&value)
+        {
+            if (Component *existing = find<Component>(entity))
+            {
+                *existing = std::forward<Value>(value);
+                return *existing;
+            }
+            component_id_t id = component_id<Component>();
+            location loc = migrate(entity, with_component(current_archetype(entity), id));
+            archetype &arch = _archetypes[loc.archetype];
+            auto &col = data<Component>(*arch.chunks[loc.chunk].columns[arch.column_index(id)]);
+            col.push_back(Component(std::forward<Value>(value)));
+            return col.back();
+        }
+
+        void erase(component_id_t id, std::size_t entity)
+        {
+            std::size_t from = current_archetype(entity);
+            if (from == npos || _archetypes[from].column_index(id) == npos)
+                return;
+            std::size_t to = without_component(from, id);
+            if (to == npos)
+                remove_entity(entity);
+            else
+                migrate(entity, to);
+        }
+
+        // Drops every archetype component of the entity at once (used when it is killed)
+        void remove_entity(std::size_t entity)
+        {
+            if (entity >= _locations.size() || _locations[entity].archetype == npos)
+                return;
+            remove_row(_locations[entity]);
+            _locations[entity] = location{};
+        }
+
+        // One past the highest entity index that ever held an archetype component
+        std::size_t entity_bound() const noexcept { return _locations.size(); }
+
+        // Makes room for entity indices below n; chunks are still created with their archetype
+        void reserve(std::size_t n) { _locations.reserve(n); }
+
+        /**
+         * @brief Calls f(count, entities, columns...) for every non-empty chunk holding all of Components.
+         *
+         * `entities` points to the entity index of each row and each column to `count` elements
+         * of the matching component (`const Component` gives a const pointer). The callback must
+         * not add or remove archetype components while the query runs.
+         */
+        template <class... Components, typename Function>
+        void for_each_chunk(Function &&f)
+        {
+            const component_id_t ids[] = {component_id<Components>()...};
+            for (auto &arch : _archetypes)
+            {
+                std::size_t cols[sizeof...(Components)];
+                bool match = true;
+                for (std::size_t k = 0; k < sizeof...(Components) && match; ++k)
+                {
+                    cols[k] = arch.column_index(ids[k]);
+                    match = cols[k] != npos;
+                }
+                if (!match)
+                    continue;
+                for (auto &ch : arch.chunks)
+                {
+                    if (!ch.entities.empty())
+                        visit_chunk<Components...>(ch, cols, f, std::index_sequence_for<Components...>{});
+                }
+            }
+        }
+
+    private:
+        struct column_base
+        {
+            virtual ~column_base() = default;
+            virtual std::unique_ptr<column_base> make_empty() const = 0;
+            // Appends src[row] (moved)
+            virtual void push_from(column_base &src, std::size_t row) = 0;
+            // this[dst] = move(src[row])
+            virtual void move_into(std::size_t dst, column_base &src, std::size_t row) = 0;
+            virtual void pop_back() = 0;
+        };
+
+        template <class Component>
+        struct column final : column_base
+        {
+            std::vector<Component> data;
+
+            std::unique_ptr<column_base> make_empty() const override
+            {
+                auto c = std::make_unique<column>();
+                c->data.reserve(chunk_capacity);
+                return c;
+            }
+            void push_from(column_base &src, std::size_t row) override
+            {
+                data.push_back(std::move(static_cast<column &>(src).data[row]));
+            }
+            void move_into(std::size_t dst, column_base &src, std::size_t row) override
+            {
+                data[dst] = std::move(static_cast<column &>(src).data[row]);
+            }
+            void pop_back() override { data.pop_back(); }
+        };
+
+        struct chunk
+        {
+            std::vector<std::size_t> entities;
+            std::vector<std::unique_ptr<column_base>> columns; // parallel to archetype::components
+        };
+
+        struct archetype
+        {
+            std::vector<component_id_t> components; // sorted
+            std::vector<std::size_t> columns;       // component id -> column, npos if absent
+            std::vector<chunk> chunks;
+            std::vector<chunk> spare; // at most one emptied chunk, kept so a row count bouncing
+                                      // around a chunk boundary does not allocate every time
+            std::unordered_map<component_id_t, std::size_t> add_edges;    // archetype with one more
+            std::unordered_map<component_id_t, std::size_t> remove_edges; // archetype with one less
+
+            std::size_t column_index(component_id_t id) const noexcept
+            {
+                return id < columns.size() ? columns[id] : npos;
+            }
+        };
+
+        struct location
+        {
+            std::size_t archetype = npos;
+            std::size_t chunk = 0;
+            std::size_t row = 0;
+        };
+
+        template <class Component>
+        static std::vector<Component> &data(column_base &c)
+        {
+            return static_cast<column<Component> &>(c).data;
+        }
+
+        template <class Component>
+        static std::vector<Component> const &data(column_base const &c)
+        {
+            return static_cast<column<Component> const &>(c).data;
+        }
+
+        template <class Component>
+        static Component *column_data(column_base &c)
+        {
+            return data<std::remove_const_t<Component>>(c).data();
+        }
+
+        template <class... Components, typename Function, std::size_t... Is>
+        static void visit_chunk(chunk &ch, std::size_t const *cols, Function &f, std::index_sequence<Is...>)
+        {
+            f(ch.entities.size(), static_cast<std::size_t const *>(ch.entities.data()),
+              column_data<Components>(*ch.columns[cols[Is]])...);
+        }
+
+        std::size_t current_archetype(std::size_t entity) const noexcept
+        {
+            return entity < _locations.size() ? _locations[entity].archetype : npos;
+        }
+
+        std::size_t with_component(std::size_t from, component_id_t id)
+        {
+            // Entities without archetype components yet (every spawn) go through _rootEdges
+            auto &edges = from != npos ? _archetypes[from].add_edges : _rootEdges;
+            auto edge = edges.find(id);
+            if (edge != edges.end())
+                return edge->second;
+            std::vector<component_id_t> set;
+            if (from != npos)
+                set = _archetypes[from].components;
+            set.insert(std::upper_bound(set.begin(), set.end(), id), id);
+            std::size_t to = archetype_for(std::move(set));
+            (from != npos ? _archetypes[from].add_edges : _rootEdges)[id] = to;
+            return to;
+        }
+
+        // npos when removing the component leaves the entity without archetype components
+        std::size_t without_component(std::size_t from, component_id_t id)
+        {
+            auto edge = _archetypes[from].remove_edges.find(id);
+            if (edge != _archetypes[from].remove_edges.end())
+                return edge->second;
+            std::vector<component_id_t> set = _archetypes[from].components;
+            set.erase(std::find(set.begin(), set.end(), id));
+            std::size_t to = set.empty() ? npos : archetype_for(std::move(set));
+            _archetypes[from].remove_edges[id] = to;
+            return to;
+        }
+
+        std::size_t archetype_for(std::vector<component_id_t> set)
+        {
+            auto it = _bySignature.find(set);
+            if (it != _bySignature.end())
+                return it->second;
+            archetype arch;
+            arch.columns.assign(set.back() + 1, npos);
+            for (std::size_t k = 0; k < set.size(); ++k)
+                arch.columns[set[k]] = k;
+            arch.components = set;
+            arch.spare.reserve(1);
+            _archetypes.push_back(std::move(arch));
+            _bySignature.emplace(std::move(set), _archetypes.size() - 1);
+            return _archetypes.size() - 1;
+        }
+
+        // Chunk of `arch` with a free row, creating one when the last is full
+        std::size_t open_chunk(archetype &arch)
+        {
+            if (!arch.chunks.empty() && arch.chunks.back().entities.size() < chunk_capacity)
+                return arch.chunks.size() - 1;
+            if (!arch.spare.empty())
+            {
+                arch.chunks.push_back(std::move(arch.spare.back()));
+                arch.spare.pop_back();
+                return arch.chunks.size() - 1;
+            }
+            chunk ch;
+            ch.entities.reserve(chunk_capacity);
+            for (component_id_t id : arch.components)
+                ch.columns.push_back(_prototypes[id]->make_empty());
+            arch.chunks.push_back(std::move(ch));
+            return arch.chunks.size() - 1;
+        }
+
+        // Moves the entity's shared components to a new row of `to`. Columns of `to` the entity
+        // did not have yet are left one element short for the caller to append.
+        location migrate(std::size_t entity, std::size_t to)
+        {
+            if (entity >= _locations.size())
+                _locations.resize(entity + 1);
+            location from = _locations[entity];
+            archetype &dst = _archetypes[to];
+            location loc{to, open_chunk(dst), 0};
+            chunk &dstChunk = dst.chunks[loc.chunk];
+            loc.row = dstChunk.entities.size();
+            dstChunk.entities.push_back(entity);
+            if (from.archetype != npos)
+            {
+                archetype &src = _archetypes[from.archetype];
+                chunk &srcChunk = src.chunks[from.chunk];
+                for (std::size_t k = 0; k < src.components.size(); ++k)
+                {
+                    std::size_t col = dst.column_index(src.components[k]);
+                    if (col != npos)
+                        dstChunk.columns[col]->push_from(*srcChunk.columns[k], from.row);
+                }
+                remove_row(from);
+            }
+            _locations[entity] = loc;
+            return loc;
+        }
+
+        // Fills the hole with the archetype's last row so chunks stay dense
+        void remove_row(location const &loc)
+        {
+            archetype &arch = _archetypes[loc.archetype];
+            chunk &ch = arch.chunks[loc.chunk];
+            chunk &last = arch.chunks.back();
+            std::size_t lastRow = last.entities.size() - 1;
+            if (&ch != &last || loc.row != lastRow)
+            {
+                for (std::size_t k = 0; k < arch.components.size(); ++k)
+                    ch.columns[k]->move_into(loc.row, *last.columns[k], lastRow);
+                std::size_t moved = last.entities[lastRow];
+                ch.entities[loc.row] = moved;
+                _locations[moved].chunk = loc.chunk;
+                _locations[moved].row = loc.row;
+            }
+            for (auto &col : last.columns)
+                col->pop_back();
+            last.entities.pop_back();
+            if (last.entities.empty())
+            {
+                if (arch.spare.empty())
+                    arch.spare.push_back(std::move(last));
+                arch.chunks.pop_back();
+            }
+        }
+
+        std::vector<std::unique_ptr<column_base>> _prototypes; // indexed by component id
+        std::vector<archetype> _archetypes;
+        std::map<std::vector<component_id_t>, std::size_t> _bySignature;
+        std::vector<location> _locations; // indexed by entity index
+        std::unordered_map<component_id_t, std::size_t> _rootEdges; // single-component archetypes
+    };
+
+    /**
+     * @brief Storage of one archetype component, with the same access API as sparse_set.
+     *
+     * The values live in the registry's archetype_table; this view resolves entity indices
+     * through it, so per-index code (zippers, lookups) keeps working, while hot loops use
+     * registry::for_each_chunk instead.
+     *
+     * @tparam Component The type of component to store.
+     */
+    template <typename Component>
+    class archetype_column
+    {
+    public:
+        using component_type = Component;
+        using size_type = std::size_t;
+
+        /**
+         * @brief Optional-like handle on the component of one entity index.
+         *
+         * Only valid until the next structural change of the entity's archetype.
+         */
+        template <bool Const>
+        class basic_slot
+        {
+            using column_t = std::conditional_t<Const, archetype_column const, archetype_column>;
+            using ref_t = std::conditional_t<Const, Component const &, Component &>;
+            using ptr_t = std::conditional_t<Const, Component const *, Component *>;
+
+        public:
+            basic_slot(column_t &column, size_type idx) : _column(&column), _idx(idx) {}
+
+            bool has_value() const noexcept { return get() != nullptr; }
+            explicit operator bool() const noexcept { return has_value(); }
+
+            ref_t value() const
+            {
+                ptr_t p = get();
+                if (!p)
+                    throw std::bad_optional_access();
+                return *p;
+            }
+            ref_t operator*() const { return *get(); }
+            ptr_t operator->() const { return get(); }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            void reset() { _column->erase(_idx); }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(std::nullopt_t)
+            {
+                _column->erase(_idx);
+                return *this;
+            }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(Component const &c)
+            {
+                _column->insert_at(_idx, c);
+                return *this;
+            }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(Component &&c)
+            {
+                _column->insert_at(_idx, std::move(c));
+                return *this;
+            }
+
+        private:
+            ptr_t get() const noexcept { return _column->_table->template find<Component>(_idx); }
+
+            column_t *_column;
+            size_type _idx;
+        };
+
+        using reference_type = basic_slot<false>;
+        using const_reference_type = basic_slot<true>;
+
+        archetype_column() = default;
+
+        // Binds the view to the table holding the values; done by registry::register_component
+        void attach(archetype_table &table)
+        {
+            _table = &table;
+            _table->register_column<Component>();
+        }
+
+        // Element access (by entity index)
+        reference_type operator[](size_type idx) { return reference_type(*this, idx); }
+        const_reference_type operator[](size_type idx) const { return const_reference_type(*this, idx); }
+
+        bool contains(size_type idx) const noexcept { return _table->find<Component>(idx) != nullptr; }
+
+        // sparse_array semantics: one past the highest entity index that may hold a value
+        size_type size() const noexcept { return _table->entity_bound(); }
+
+        void reserve(size_type n) { _table->reserve(n); }
+
+        // Modifiers
+        reference_type insert_at(size_type pos, Component const &c)
+        {
+            if (!contains(pos))
+                _changes.record(pos);
+            _table->insert<Component>(pos, c);
+            return (*this)[pos];
+        }
+
+        reference_type insert_at(size_type pos, Component &&c)
+        {
+            if (!contains(pos))
+                _changes.record(pos);
+            _table->insert<Component>(pos, std::move(c));
+            return (*this)[pos];
+        }
+
+        template <class... Params>
+        reference_type emplace_at(size_type pos, Params &&...params)
+        {
+            if (!contains(pos))
+                _changes.record(pos);
+            _table->insert<Component>(pos, Component(std::forward<Params>(params)...));
+            return (*this)[pos];
+        }
+
+        void erase(size_type pos)
+        {
+            if (!contains(pos))
+                return;
+            _table->erase(component_id<Component>(), pos);
+            _changes.record(pos);
+        }
+
+        // Records the loss of pos's value without touching the table: a killed entity's archetype
+        // components are dropped all at once by archetype_table::remove_entity afterwards.
+        void note_removed(size_type pos)
+        {
+            if (contains(pos))
+                _changes.record(pos);
+        }
+
+        // Entity indices whose component appeared or disappeared, for cached views
+        membership_log &changes() noexcept { return _changes; }
+        membership_log const &changes() const noexcept { return _changes; }
+
+    private:
+        archetype_table *_table = nullptr;
+        membership_log _changes;
+    };
+
+}
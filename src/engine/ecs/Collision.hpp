@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "engine/ecs/Components.hpp"
+/**
+ * @file Collision.hpp
+ * @brief Broad-phase helpers used by hitbox_system.
+ *
+ * - collision_matrix: declares which pairs of entity kinds may collide. Kinds with an empty row
+ *   (decor, effects...) never enter the broad phase, and disallowed pairs (e.g. projectile vs
+ *   projectile) are rejected with a single bit test before any AABB math.
+ * - spatial_hash: uniform grid broad phase. Boxes are bucketed into fixed-size cells by sorting
+ *   (cell, entity) entries, so the grid has no per-cell allocation and its buffers are reused
+ *   from one tick to the next. Each overlapping pair is reported exactly once: only in the cell
+ *   holding the min corner of the two boxes' intersection.
+ */
+namespace engine
+{
+    class collision_matrix
+    {
+    public:
+        static constexpr std::size_t max_kinds = 32;
+
+        collision_matrix &allow(component::entity_kind a, component::entity_kind b)
+        {
+            auto ia = index(a);
+            auto ib = index(b);
+            if (ia >= max_kinds || ib >= max_kinds)
+                return *this;
+            _masks[ia] |= 1u << ib;
+            _masks[ib] |= 1u << ia;
+            return *this;
+        }
+
+        static std::uint32_t category(component::entity_kind k)
+        {
+            auto i = index(k);
+            return i < max_kinds ? 1u << i : 0u;
+        }
+
+        std::uint32_t mask(component::entity_kind k) const
+        {
+            auto i = index(k);
+            return i < max_kinds ? _masks[i] : 0u;
+        }
+
+    private:
+        static std::size_t index(component::entity_kind k) { return static_cast<std::size_t>(k); }
+
+        std::array<std::uint32_t, max_kinds> _masks{};
+    };
+
+    class spatial_hash
+    {
+    public:
+        explicit spatial_hash(float cellSize = 128.f) : _cellSize(cellSize), _invCell(1.f / cellSize) {}
+
+        void clear()
+        {
+            _boxes.clear();
+            _entries.clear();
+        }
+
+        // Makes room for `boxes` boxes of up to 2x2 cells each without reallocating
+        void reserve(std::size_t boxes)
+        {
+            _boxes.reserve(boxes);
+            _entries.reserve(boxes * 4);
+        }
+
+        /**
+         * @brief Adds an axis-aligned box [x1, x2] x [y1, y2] owned by entity index `idx`.
+         * @param category Bit(s) identifying what this box is.
+         * @param mask Categories this box may collide with.
+         */
+        void insert(std::size_t idx, float x1, float y1, float x2, float y2,
+                    std::uint32_t category = ~0u, std::uint32_t mask = ~0u)
+        {
+            if (!(x1 <= x2) || !(y1 <= y2) || mask == 0 || category == 0)
+                return;
+            auto slot = static_cast<std::uint32_t>(_boxes.size());
+            _boxes.push_back({x1, y1, x2, y2, idx, category, mask});
+            std::int32_t cx1 = cell(x1), cx2 = cell(x2);
+            std::int32_t cy1 = cell(y1), cy2 = cell(y2);
+            for (std::int32_t cx = cx1; cx <= cx2; ++cx)
+                for (std::int32_t cy = cy1; cy <= cy2; ++cy)
+                    _entries.push_back({key(cx, cy), slot});
+        }
+
+        /**
+         * @brief Calls f(i, j) (i < j) once per pair of boxes sharing a cell whose
+         *        categories/masks match and whose boxes overlap.
+         */
+        template <typename Function>
+        void for_each_pair(Function &&f)
+        {
+            std::sort(_entries.begin(), _entries.end(),
+                      [](entry const &a, entry const &b)
+                      { return a.key < b.key || (a.key == b.key && a.slot < b.slot); });
+
+            std::size_t begin = 0;
+            while (begin < _entries.size())
+            {
+                std::size_t end = begin + 1;
+                while (end < _entries.size() && _entries[end].key == _entries[begin].key)
+                    ++end;
+                for (std::size_t a = begin; a + 1 < end; ++a)
+                {
+                    box const &A = _boxes[_entries[a].slot];
+                    for (std::size_t b = a + 1; b < end; ++b)
+                    {
+                        box const &B = _boxes[_entries[b].slot];
+                        if (!(A.category & B.mask) && !(B.category & A.mask))
+                            continue;
+                        if (A.x1 >= B.x2 || A.x2 <= B.x1 || A.y1 >= B.y2 || A.y2 <= B.y1)
+                            continue;
+                        // Report only from the cell owning the intersection's min corner
+                        if (key(cell(std::max(A.x1, B.x1)), cell(std::max(A.y1, B.y1))) != _entries[begin].key)
+                            continue;
+                        if (A.idx < B.idx)
+                            f(A.idx, B.idx);
+                        else
+                            f(B.idx, A.idx);
+                    }
+                }
+                begin = end;
+            }
+        }
+
+        float cell_size() const { return _cellSize; }
+
+    private:
+        struct box
+        {
+            float x1, y1, x2, y2;
+            std::size_t idx;
+            std::uint32_t category;
+            std::uint32_t mask;
+        };
+
+        struct entry
+        {
+            std::uint64_t key;
+            std::uint32_t slot;
+        };
+
+        std::int32_t cell(float v) const { return static_cast<std::int32_t>(std::floor(v * _invCell)); }
+
+        static std::uint64_t key(std::int32_t cx, std::int32_t cy)
+        {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+                   static_cast<std::uint32_t>(cy);
+        }
+
+        float _cellSize;
+        float _invCell;
+        std::vector<box> _boxes;
+        std::vector<entry> _entries;
+    };
+
+}
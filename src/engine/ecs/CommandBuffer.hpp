@@ -0,0 +1,172 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "Entity.hpp"
+#include "engine/memory/BumpArena.hpp"
+/**
+ * @file CommandBuffer.hpp
+ * @brief Defines engine::command_buffer, structural ECS changes recorded now and applied later.
+ *
+ * Killing entities or adding/removing components while a loop walks the storages involved can
+ * move or free what the loop is looking at, hence the `toKill` vectors systems used to build.
+ * Systems record such changes with registry::commands() instead and the registry applies them
+ * at a sync point (see registry::run_systems), in recording order. Every system has its own
+ * buffer, so systems running in the same parallel stage can record without locking.
+ *
+ * Commands and the values they carry live in a bump_arena that is reset by each flush: once it
+ * has grown to fit a tick, recording no longer allocates.
+ *
+ * Commands targeting an entity that is dead by the time they are applied are dropped.
+ */
+namespace engine
+{
+    class registry;
+
+    template <class Registry>
+    class basic_command_buffer
+    {
+    public:
+        basic_command_buffer() = default;
+        ~basic_command_buffer() { clear(); }
+
+        basic_command_buffer(basic_command_buffer const &) = delete;
+        basic_command_buffer &operator=(basic_command_buffer const &) = delete;
+
+        void kill(entity_t e)
+        {
+            push([e](Registry &r) { r.kill_entity(e); });
+        }
+
+        // Adds (or overwrites) e's Component
+        template <class Component>
+        void add(entity_t e, Component &&c)
+        {
+            push([e, c = std::forward<Component>(c)](Registry &r) mutable
+                 {
+                     if (r.is_alive(e))
+                         r.add_component(e, std::move(c));
+                 });
+        }
+
+        template <class Component>
+        void remove(entity_t e)
+        {
+            push([e](Registry &r)
+                 {
+                     if (r.is_alive(e))
+                         r.template remove_component<Component>(e);
+                 });
+        }
+
+        // Calls f(component) on e's Component, value-initialising it first when e has none;
+        // accumulations (damage...) recorded several times in a tick then all apply.
+        template <class Component, typename Function>
+        void patch(entity_t e, Function &&f)
+        {
+            push([e, f = std::forward<Function>(f)](Registry &r) mutable
+                 {
+                     if (!r.is_alive(e))
+                         return;
+                     auto &storage = r.template get_components<Component>();
+                     std::size_t idx = static_cast<std::size_t>(e);
+                     if (idx >= storage.size() || !storage[idx])
+                         storage.insert_at(idx, Component{});
+                     f(*storage[idx]);
+                 });
+        }
+
+        // Spawns an entity when applied and calls f(registry, entity) to build it
+        template <typename Function>
+        void spawn(Function &&f)
+        {
+            push([f = std::forward<Function>(f)](Registry &r) mutable { f(r, r.spawn_entity()); });
+        }
+
+        // Calls f(registry) when applied, for changes the commands above do not cover
+        template <typename Function>
+        void defer(Function &&f)
+        {
+            push(std::forward<Function>(f));
+        }
+
+        bool empty() const noexcept { return _head == nullptr; }
+        std::size_t size() const noexcept { return _count; }
+
+        // Applies the commands in recording order, then recycles their memory.
+        void flush(Registry &r)
+        {
+            while (_head)
+            {
+                node *n = _head;
+                n->apply(n, r);
+                _head = n->next;
+                n->destroy(n);
+            }
+            _tail = nullptr;
+            _count = 0;
+            _arena.reset();
+        }
+
+        // Grows the arena to hold about `bytes` of commands before the heap is hit again
+        void reserve(std::size_t bytes) { _arena.reserve(bytes); }
+
+        // Drops the commands without applying them
+        void clear() noexcept
+        {
+            while (_head)
+            {
+                node *n = _head;
+                _head = n->next;
+                n->destroy(n);
+            }
+            _tail = nullptr;
+            _count = 0;
+            _arena.reset();
+        }
+
+    private:
+        struct node
+        {
+            void (*apply)(node *, Registry &) = nullptr;
+            void (*destroy)(node *) noexcept = nullptr;
+            node *next = nullptr;
+        };
+
+        template <class Function>
+        struct command final : node
+        {
+            template <class F>
+            explicit command(F &&f) : fn(std::forward<F>(f))
+            {
+                this->apply = &command::run;
+                this->destroy = &command::release;
+            }
+
+            static void run(node *n, Registry &r) { static_cast<command *>(n)->fn(r); }
+            static void release(node *n) noexcept { static_cast<command *>(n)->~command(); }
+
+            Function fn;
+        };
+
+        template <typename Function>
+        void push(Function &&f)
+        {
+            node *n = _arena.create<command<std::decay_t<Function>>>(std::forward<Function>(f));
+            if (_tail)
+                _tail->next = n;
+            else
+                _head = n;
+            _tail = n;
+            ++_count;
+        }
+
+        bump_arena _arena;
+        node *_head = nullptr;
+        node *_tail = nullptr;
+        std::size_t _count = 0;
+    };
+
+    using command_buffer = basic_command_buffer<registry>;
+
+}
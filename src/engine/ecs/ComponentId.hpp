@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+/**
+ * @file ComponentId.hpp
+ * @brief Dense integer ids for component types, used by engine::registry to index its storages.
+ *
+ * Each component type gets the next free id the first time component_id<Component>() is
+ * evaluated (in practice when it is registered). The ids are shared by every registry in the
+ * process and stay small and contiguous, so a registry can keep its storages in a flat vector
+ * and find one with a single index instead of hashing a std::type_index.
+ */
+namespace engine
+{
+    using component_id_t = std::size_t;
+
+    namespace detail
+    {
+        inline component_id_t next_component_id() noexcept
+        {
+            static std::atomic<component_id_t> next{0};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // cv-qualifiers are ignored: `const position` and `position` share an id
+    template <class Component>
+    component_id_t component_id() noexcept
+    {
+        if constexpr (!std::is_same_v<Component, std::remove_cv_t<Component>>)
+            return component_id<std::remove_cv_t<Component>>();
+        else
+        {
+            static const component_id_t id = detail::next_component_id();
+            return id;
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <string>
 #include <functional>
+#include "engine/ecs/Storage.hpp"
 
 namespace engine
 {
@@ -32,12 +33,24 @@ namespace component
         decor = 6,
         missile_explosion = 9
     };
+}
+
+namespace engine
+{
+    // Read by the bounds and snapshot passes alongside position/velocity
+    template <>
+    inline constexpr bool archetype_storage_v<component::entity_kind> = true;
+}
+
+namespace component
+{
     /**
      * @brief Basic 2D position component.
      */
 
     struct position
     {
+        static constexpr bool archetype_storage = true;
         float x{}, y{};
         position() = default;
         position(float x_, float y_) : x(x_), y(y_) {}
@@ -48,6 +61,7 @@ namespace component
      */
     struct velocity
     {
+        static constexpr bool archetype_storage = true;
         float vx{}, vy{};
         velocity() = default;
         velocity(float vx_, float vy_) : vx(vx_), vy(vy_) {}
@@ -137,23 +151,27 @@ namespace component
 
     struct projectile_tag
     {
+        static constexpr bool archetype_storage = true;
         std::uint32_t owner{0};
         std::uint32_t lifetime{180};
         float dirX{1.f};
         float dirY{0.f};
         float speed{20.f};
         int damage{1};
+        std::uint32_t rewindTicks{0}; // enemies are tested as of this many ticks ago (lag compensation)
     };
 
     // Simple gravity acceleration for ballistic movement (adds to projectile_tag.dirY each tick)
     struct gravity
     {
+        static constexpr bool archetype_storage = true;
         float ay{0.03f};
     };
 
     // Area-of-effect applied once on spawn (or first tick) for explosion entities
     struct area_effect
     {
+        static constexpr bool packed_storage = true;
         float radius{100.f};
         int damage{1};
         bool applied{false};
@@ -170,8 +188,10 @@ namespace component
         bool loop = false;
     };
 
+    // Bulky: kept in packed storage so entities without animation only cost an index
     struct animation
     {
+        static constexpr bool packed_storage = true;
         std::unordered_map<std::string, AnimationClip> clips;
         std::string currentClip = "idle";
         int currentFrame = 0;
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 /**    * @file Entity.hpp
     * @brief A simple wrapper for entity identifiers in the ECS.
     */
@@ -25,6 +26,19 @@ namespace engine
      * @return The unique identifier of the entity.
      */
 
+    /**
+     * @brief Returns the generation of the slot this entity was spawned in.
+     *
+     * The registry recycles the indices of killed entities and bumps the slot generation,
+     * so a handle kept after its entity died no longer matches registry::is_alive().
+     */
+
+    /**
+     * @brief Packs index and generation into a 32-bit handle (used as the network entity id).
+     *
+     * The low index_bits hold the index, the remaining high bits the generation (wrapping).
+     */
+
     /**
      * @brief Checks if two entity_t instances represent the same entity.
      * @param other The entity_t to compare with.
@@ -39,7 +53,12 @@ namespace engine
     {
         /** @brief Construct an entity_t from a std::size_t */
     public:
-        explicit entity_t(std::size_t id) : _id(id) {}
+        static constexpr unsigned index_bits = 20;
+        static constexpr std::uint32_t index_mask = (1u << index_bits) - 1;
+        static constexpr std::uint32_t generation_mask = (1u << (32 - index_bits)) - 1;
+
+        explicit entity_t(std::size_t id, std::uint32_t generation = 0)
+            : _id(id), _generation(generation & generation_mask) {}
 
         entity_t(const entity_t &) = default;
         entity_t(entity_t &&) noexcept = default;
@@ -47,17 +66,30 @@ namespace engine
         entity_t &operator=(entity_t &&) noexcept = default;
 
         operator std::size_t() const noexcept { return _id; }
-        
+
+        std::uint32_t generation() const noexcept { return _generation; }
+
+        std::uint32_t handle() const noexcept
+        {
+            return (_generation << index_bits) | (static_cast<std::uint32_t>(_id) & index_mask);
+        }
+
+        static entity_t from_handle(std::uint32_t handle) noexcept
+        {
+            return entity_t(handle & index_mask, handle >> index_bits);
+        }
+
         bool operator==(const entity_t &other) const noexcept
         {
-            return _id == other._id;
+            return _id == other._id && _generation == other._generation;
         }
         bool operator!=(const entity_t &other) const noexcept
         {
-            return _id != other._id;
+            return !(*this == other);
         }
 
     private:
         std::size_t _id;
+        std::uint32_t _generation;
     };
 }
@@ -2,7 +2,6 @@
 #include "engine/ecs/Registry.hpp"
 #include <type_traits>
 #include <utility>
-#include <stdexcept>
 /**
  * @file EntityFactory.hpp
  * @brief Defines utilities for creating entities with components in the ECS engine.
@@ -20,23 +19,14 @@ namespace engine
      * @param r Reference to the registry.
      * @param comps Instances of components to add to the entity.
      * @return entity_t The newly created entity.
-     *
-     * @throws std::bad_any_cast If a component array exists but is of the wrong type.
      */
     namespace detail
     {
         template <typename Component>
         void ensure_component_array(registry &r)
         {
-            try {
-                (void)r.get_components<Component>();
-            }
-            catch (std::bad_any_cast const &) {
-                throw;
-            }
-            catch (std::out_of_range const &) {
+            if (!r.is_registered<Component>())
                 r.register_component<Component>();
-            }
         }
     }
 
@@ -0,0 +1,82 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "engine/ecs/Entity.hpp"
+/**
+ * @file EntitySet.hpp
+ * @brief Defines engine::entity_set, a set of entity indices stored as one bit per index.
+ *
+ * The bits cover the registry's whole index space (entity_t::index_mask + 1 indices, 128 KiB)
+ * and are allocated once by the constructor: inserting and erasing never touch the heap,
+ * unlike a node-based set where every spawn allocates. Iteration visits indices in increasing
+ * order and skips empty 64-index words, up to the highest index ever inserted.
+ */
+namespace engine
+{
+    class entity_set
+    {
+    public:
+        static constexpr std::size_t capacity = std::size_t{entity_t::index_mask} + 1;
+
+        entity_set() : _words(capacity / word_bits, 0) {}
+
+        // Indices at or above capacity cannot be registry indices and are ignored
+        void insert(std::size_t index)
+        {
+            if (index >= capacity)
+                return;
+            std::uint64_t &word = _words[index / word_bits];
+            const std::uint64_t bit = std::uint64_t{1} << (index % word_bits);
+            if (word & bit)
+                return;
+            word |= bit;
+            ++_size;
+            if (index / word_bits >= _usedWords)
+                _usedWords = index / word_bits + 1;
+        }
+
+        void erase(std::size_t index)
+        {
+            if (index >= capacity)
+                return;
+            std::uint64_t &word = _words[index / word_bits];
+            const std::uint64_t bit = std::uint64_t{1} << (index % word_bits);
+            if (!(word & bit))
+                return;
+            word &= ~bit;
+            --_size;
+        }
+
+        bool contains(std::size_t index) const
+        {
+            return index < capacity && (_words[index / word_bits] >> (index % word_bits)) & 1u;
+        }
+
+        std::size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+
+        // Calls f(index) for every index in the set, in increasing order
+        template <typename Function>
+        void for_each(Function &&f) const
+        {
+            for (std::size_t w = 0; w < _usedWords; ++w)
+            {
+                std::uint64_t bits = _words[w];
+                while (bits)
+                {
+                    f(w * word_bits + static_cast<std::size_t>(std::countr_zero(bits)));
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t word_bits = 64;
+
+        std::vector<std::uint64_t> _words;
+        std::size_t _usedWords = 0; // words past this one have never held a bit
+        std::size_t _size = 0;
+    };
+}
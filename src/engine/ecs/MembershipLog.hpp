@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+/**
+ * @file MembershipLog.hpp
+ * @brief Defines engine::membership_log, the record of entity indices whose component came or went.
+ *
+ * Every component storage owns one. Insertions of a new value and erasures append the entity
+ * index; overwriting an existing value does not. engine::cached_view replays the records it has
+ * not seen yet to update its match list instead of rescanning the storages.
+ *
+ * Nothing is recorded until a view watches the log, so storages nobody queries pay a single
+ * branch. The log keeps at most max_records entries, allocated when it is first watched; once
+ * full it starts over and a view that had not caught up rebuilds its list from scratch.
+ */
+namespace engine
+{
+    class membership_log
+    {
+    public:
+        static constexpr std::size_t max_records = 1 << 14;
+
+        void watch()
+        {
+            if (!_watched)
+                _records.reserve(max_records);
+            _watched = true;
+        }
+        bool watched() const noexcept { return _watched; }
+
+        void record(std::size_t idx)
+        {
+            if (!_watched)
+                return;
+            if (_records.size() == max_records)
+            {
+                _base += _records.size();
+                _records.clear();
+            }
+            _records.push_back(idx);
+        }
+
+        // Sequence number of the next record
+        std::size_t version() const noexcept { return _base + _records.size(); }
+
+        // Calls f(idx) for every record from sequence number `since` on; false if some were dropped.
+        template <typename Function>
+        bool replay(std::size_t since, Function &&f) const
+        {
+            if (since < _base)
+                return false;
+            for (std::size_t k = since - _base; k < _records.size(); ++k)
+                f(_records[k]);
+            return true;
+        }
+
+    private:
+        std::vector<std::size_t> _records;
+        std::size_t _base = 0; // sequence number of _records[0]
+        bool _watched = false;
+    };
+
+}
@@ -1,14 +1,20 @@
 #pragma once
 
-#include <unordered_map>
-#include <typeindex>
-#include <typeinfo>
-#include <any>
 #include <functional>
+#include <memory>
+#include <stdexcept>
 #include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
 
+#include "Archetype.hpp"
+#include "CommandBuffer.hpp"
+#include "ComponentId.hpp"
 #include "Entity.hpp"
-#include "Sparse_array.hpp"
+#include "Storage.hpp"
+#include "View.hpp"
+#include "engine/threading/ThreadPool.hpp"
 /**
     * @file Registry.hpp
     * @brief A simple ECS registry to manage entities and their components.
@@ -20,12 +26,34 @@ namespace engine
      * @brief Manages entity creation, deletion, and component association in an ECS (Entity Component System).
      *
      * This class provides:
-     * - Creation and removal of entities.
+     * - Creation and removal of entities, recycling freed indices with generation counters.
      * - Dynamic registration and management of components associated with entities.
      * - Adding, removing, and accessing components for each entity.
      * - Management of systems (functions) that operate on sets of components.
      *
-     * Uses sparse arrays to efficiently store components.
+     * Components are stored in sparse arrays by default, or in packed sparse sets or archetype
+     * chunks when the component opts in (see Storage.hpp); storage_t<Component> names the
+     * selected container. Archetype components are also iterated chunk by chunk with
+     * for_each_chunk.
+     * Storages are found by component_id<Component>() in a flat vector, so looking one up is an
+     * index and a static_cast rather than a hash lookup plus std::any_cast.
+     *
+     * view<Components...>() returns a persistent query whose list of matching entities is
+     * kept up to date from the storages' membership logs, so systems over rare components do
+     * not rescan the whole entity range every tick (see View.hpp).
+     *
+     * Systems run in registration order unless a thread pool is attached (set_thread_pool).
+     * Then systems added with add_parallel_system, which declare what they read (`const`
+     * parameters) and write, are grouped into stages of mutually non-conflicting systems
+     * that run concurrently. Systems added with add_system may do anything (spawn, kill,
+     * reach other components) and therefore always run alone, in order.
+     *
+     * Structural changes a system wants to make while iterating are recorded with commands()
+     * and applied after the system (serial run) or after its stage (parallel run); see
+     * CommandBuffer.hpp.
+     *
+     * reserve() sizes the entity-indexed buffers (storages, views, free list, command arenas)
+     * for an expected entity count up front, so spawning and killing below it never allocates.
      */
     class registry
     {
@@ -34,67 +62,127 @@ namespace engine
         ~registry() = default;
 
         template <class Component>
-        sparse_array<Component> &register_component()
+        storage_t<Component> &register_component()
         {
-            std::type_index ti(typeid(Component));
-            if (_components_arrays.find(ti) == _components_arrays.end())
+            component_id_t id = component_id<Component>();
+            if (id >= _pools.size())
+                _pools.resize(id + 1);
+            if (!_pools[id])
             {
-                _components_arrays[ti] = sparse_array<Component>();
-                _erase_funcs[ti] = [](registry &r, entity_t const &e)
-                {
-                    auto &arr = r.get_components<Component>();
-                    arr.erase(static_cast<std::size_t>(e));
-                };
+                auto p = std::make_unique<pool<Component>>();
+                if constexpr (archetype_storage_v<Component>)
+                    p->data.attach(*_archetypes);
+                p->reserve(_reserved);
+                _pools[id] = std::move(p);
             }
-            return std::any_cast<sparse_array<Component> &>(_components_arrays[ti]);
+            return static_cast<pool<Component> &>(*_pools[id]).data;
         }
 
         template <class Component>
-        sparse_array<Component> &get_components()
+        bool is_registered() const noexcept
         {
-            return std::any_cast<sparse_array<Component> &>(_components_arrays.at(std::type_index(typeid(Component))));
+            component_id_t id = component_id<Component>();
+            return id < _pools.size() && _pools[id];
         }
 
+        // Throws std::out_of_range when Component was never registered.
         template <class Component>
-        sparse_array<Component> const &get_components() const
+        storage_t<Component> &get_components()
         {
-            return std::any_cast<sparse_array<Component> const &>(_components_arrays.at(std::type_index(typeid(Component))));
+            return static_cast<pool<Component> &>(pool_of<Component>()).data;
         }
 
+        template <class Component>
+        storage_t<Component> const &get_components() const
+        {
+            return static_cast<pool<Component> const &>(pool_of<Component>()).data;
+        }
+
+        // Reuses the most recently freed index when available; its generation was bumped on kill.
         entity_t spawn_entity()
         {
-            entity_t e(_next_entity_id++);
-            _alive.push_back(static_cast<std::size_t>(e));
-            return e;
+            std::size_t idx;
+            if (!_free_indices.empty())
+            {
+                idx = _free_indices.back();
+                _free_indices.pop_back();
+            }
+            else
+            {
+                idx = _generations.size();
+                _generations.push_back(0);
+                _alive.push_back(false);
+            }
+            _alive[idx] = true;
+            return entity_t(idx, _generations[idx]);
         }
 
+        // O(1) apart from clearing the entity's components; stale handles are ignored.
         void kill_entity(entity_t const &e)
         {
-            auto it = std::find(_alive.begin(), _alive.end(), static_cast<std::size_t>(e));
-            if (it != _alive.end())
+            if (!is_alive(e))
+                return;
+            std::size_t idx = static_cast<std::size_t>(e);
+            _alive[idx] = false;
+            _generations[idx] = (_generations[idx] + 1) & entity_t::generation_mask;
+            _free_indices.push_back(idx);
+            for (auto &p : _pools)
             {
-                _alive.erase(it);
-                for (auto &[ti, erase_fn] : _erase_funcs)
-                {
-                    erase_fn(*this, e);
-                }
+                if (p)
+                    p->erase(idx);
+            }
+            _archetypes->remove_entity(idx);
+        }
+
+        /**
+         * @brief Sizes every entity-indexed buffer for `entities` live entities, indices below it.
+         *
+         * Also applies to components, views and systems added afterwards. Command arenas get
+         * command_bytes_per_entity per entity.
+         */
+        void reserve(std::size_t entities)
+        {
+            _reserved = entities;
+            _alive.reserve(entities);
+            _generations.reserve(entities);
+            _free_indices.reserve(entities);
+            _archetypes->reserve(entities);
+            for (auto &p : _pools)
+            {
+                if (p)
+                    p->reserve(entities);
             }
+            for (auto &v : _views)
+            {
+                if (v)
+                    v->reserve(entities);
+            }
+            for (auto &system : _systems)
+                system.commands->reserve(entities * command_bytes_per_entity);
+            _commands.reserve(entities * command_bytes_per_entity);
+        }
+
+        bool is_alive(entity_t const &e) const
+        {
+            std::size_t idx = static_cast<std::size_t>(e);
+            return idx < _alive.size() && _alive[idx] && _generations[idx] == e.generation();
         }
 
-        entity_t entity_from_index(std::size_t idx)
+        // Handle of whatever currently occupies `idx` (current generation).
+        entity_t entity_from_index(std::size_t idx) const
         {
-            return entity_t(idx);
+            return entity_t(idx, idx < _generations.size() ? _generations[idx] : 0);
         }
 
         template <typename Component>
-        typename sparse_array<Component>::reference_type
+        typename storage_t<Component>::reference_type
         add_component(entity_t const &e, Component &&c)
         {
             return get_components<Component>().insert_at(static_cast<std::size_t>(e), std::move(c));
         }
 
         template <typename Component, typename... Params>
-        typename sparse_array<Component>::reference_type
+        typename storage_t<Component>::reference_type
         emplace_component(entity_t const &e, Params &&...params)
         {
             return get_components<Component>().emplace_at(static_cast<std::size_t>(e),
@@ -107,28 +195,264 @@ namespace engine
             get_components<Component>().erase(static_cast<std::size_t>(e));
         }
 
+        // Storage of a system parameter: `const Component` gives read-only access
+        template <class Component>
+        using param_t = std::conditional_t<std::is_const_v<Component>,
+                                           storage_t<std::remove_const_t<Component>> const &,
+                                           storage_t<Component> &>;
+
+        /**
+         * @brief Calls f(count, entities, columns...) for every chunk of entities having all of Components.
+         *
+         * Components must use archetype storage; `const Component` yields a read-only column.
+         * Columns are plain arrays of `count` values, so loops over them need no presence checks.
+         */
+        template <class... Components, typename Function>
+        void for_each_chunk(Function &&f)
+        {
+            static_assert((archetype_storage_v<std::remove_const_t<Components>> && ...),
+                          "for_each_chunk only iterates archetype-stored components");
+            _archetypes->for_each_chunk<Components...>(std::forward<Function>(f));
+        }
+
+        /**
+         * @brief Cached query over the entities holding all of Components, created on first use.
+         *
+         * Registers the components if needed. Creating a view is a structural change of the
+         * registry: do it during setup (e.g. capture it when adding a parallel system) or from
+         * an exclusive system, not from a parallel one.
+         */
+        template <class... Components>
+        cached_view<Components...> &view()
+        {
+            using view_t = cached_view<Components...>;
+            std::size_t id = detail::view_id<view_t>();
+            if (id >= _views.size())
+                _views.resize(id + 1);
+            if (!_views[id])
+            {
+                (register_component<std::remove_const_t<Components>>(), ...);
+                (get_components<std::remove_const_t<Components>>().changes().watch(), ...);
+                _views[id] = std::make_unique<view_t>(&get_components<std::remove_const_t<Components>>()...);
+                _views[id]->reserve(_reserved);
+            }
+            return static_cast<view_t &>(*_views[id]);
+        }
+
+        // Exclusive system: runs alone, may make structural changes through the registry.
         template <class... Components, typename Function>
         void add_system(Function &&f)
         {
-            _systems.emplace_back(
-                [func = std::forward<Function>(f)](registry &r)
-                {
-                    func(r, r.get_components<Components>()...);
-                });
+            system_entry entry;
+            entry.run = [func = std::forward<Function>(f)](registry &r)
+            {
+                func(r, r.get_param<Components>()...);
+            };
+            entry.exclusive = true;
+            entry.commands->reserve(_reserved * command_bytes_per_entity);
+            _systems.push_back(std::move(entry));
+            _stages.clear();
         }
 
+        /**
+         * @brief Adds a system that may run concurrently with the systems it does not conflict with.
+         *
+         * The system must only touch the listed components, read-only for `const` ones, and
+         * must not spawn or kill entities nor add/remove components itself: it records those
+         * with commands(), applied when its stage ends. Two such systems conflict when one
+         * writes a component the other reads or writes; conflicting systems keep their
+         * registration order.
+         */
+        template <class... Components, typename Function>
+        void add_parallel_system(Function &&f)
+        {
+            system_entry entry;
+            entry.run = [func = std::forward<Function>(f)](registry &r)
+            {
+                func(r, r.get_param<Components>()...);
+            };
+            (record_access<Components>(entry), ...);
+            entry.commands->reserve(_reserved * command_bytes_per_entity);
+            _systems.push_back(std::move(entry));
+            _stages.clear();
+        }
+
+        // Pool used by run_systems for parallel stages; nullptr (default) runs everything serially.
+        void set_thread_pool(thread_pool *pool) noexcept { _pool = pool; }
+
+        /**
+         * @brief Buffer for deferred structural changes.
+         *
+         * Inside a system run by run_systems this is the system's own buffer, applied once the
+         * system (or its stage) finished. Elsewhere it is the registry's buffer, applied by
+         * flush_commands() and at the start and end of run_systems.
+         */
+        command_buffer &commands() noexcept
+        {
+            binding const &b = current_binding();
+            return b.owner == this ? *b.buffer : _commands;
+        }
+
+        void flush_commands() { _commands.flush(*this); }
+
         void run_systems()
         {
-            for (auto &system : _systems)
-                system(*this);
-        }   
+            flush_commands();
+            if (!_pool)
+            {
+                for (auto &system : _systems)
+                {
+                    run_system(system);
+                    system.commands->flush(*this);
+                }
+            }
+            else
+            {
+                if (_stages.empty())
+                    build_stages();
+                for (auto &stage : _stages)
+                {
+                    if (stage.size() == 1)
+                        run_system(_systems[stage.front()]);
+                    else
+                        _pool->parallel_for(stage.size(), [&](std::size_t i) { run_system(_systems[stage[i]]); });
+                    // Sync point: apply the stage's changes in registration order
+                    for (std::size_t idx : stage)
+                        _systems[idx].commands->flush(*this);
+                }
+            }
+            flush_commands();
+        }
+
+    private:
+        // Arena bytes reserved per entity in each command buffer: room for a command or two
+        static constexpr std::size_t command_bytes_per_entity = 64;
+
+        // Type-erased owner of one component storage
+        struct pool_base
+        {
+            virtual ~pool_base() = default;
+            virtual void erase(std::size_t idx) = 0;
+            virtual void reserve(std::size_t n) = 0;
+        };
+
+        template <class Component>
+        struct pool final : pool_base
+        {
+            storage_t<Component> data;
+            void reserve(std::size_t n) override { data.reserve(n); }
+            // Only used by kill_entity, which then drops the archetype row in one go
+            void erase(std::size_t idx) override
+            {
+                if constexpr (archetype_storage_v<Component>)
+                    data.note_removed(idx);
+                else
+                    data.erase(idx);
+            }
+        };
+
+        template <class Component>
+        pool_base &pool_of() const
+        {
+            component_id_t id = component_id<Component>();
+            if (id >= _pools.size() || !_pools[id])
+                throw std::out_of_range("registry: component not registered");
+            return *_pools[id];
+        }
+
+        struct system_entry
+        {
+            std::function<void(registry &)> run;
+            std::vector<component_id_t> reads;
+            std::vector<component_id_t> writes;
+            bool exclusive = false;
+            std::unique_ptr<command_buffer> commands = std::make_unique<command_buffer>();
+        };
+
+        // Buffer commands() hands out on this thread while one of `owner`'s systems runs
+        struct binding
+        {
+            registry const *owner = nullptr;
+            command_buffer *buffer = nullptr;
+        };
+
+        static binding &current_binding() noexcept
+        {
+            thread_local binding current;
+            return current;
+        }
+
+        // Restores the previous binding afterwards: a worker waiting in a nested parallel_for
+        // may run another registry's systems in between.
+        void run_system(system_entry &system)
+        {
+            struct rebind
+            {
+                binding &current;
+                binding saved;
+                ~rebind() { current = saved; }
+            } guard{current_binding(), current_binding()};
+            guard.current = binding{this, system.commands.get()};
+            system.run(*this);
+        }
+
+        template <class Component>
+        param_t<Component> get_param()
+        {
+            return get_components<std::remove_const_t<Component>>();
+        }
+
+        template <class Component>
+        static void record_access(system_entry &entry)
+        {
+            if constexpr (std::is_const_v<Component>)
+                entry.reads.push_back(component_id<Component>());
+            else
+                entry.writes.push_back(component_id<Component>());
+        }
+
+        static bool overlaps(std::vector<component_id_t> const &a, std::vector<component_id_t> const &b)
+        {
+            return std::any_of(a.begin(), a.end(), [&](component_id_t id)
+                               { return std::find(b.begin(), b.end(), id) != b.end(); });
+        }
+
+        static bool conflicts(system_entry const &a, system_entry const &b)
+        {
+            return a.exclusive || b.exclusive || overlaps(a.writes, b.reads) || overlaps(a.writes, b.writes) ||
+                   overlaps(b.writes, a.reads);
+        }
+
+        // Each system goes one stage after the last earlier system it conflicts with, so
+        // dependent systems keep their order and independent ones share a stage.
+        void build_stages()
+        {
+            std::vector<std::size_t> level(_systems.size(), 0);
+            for (std::size_t i = 0; i < _systems.size(); ++i)
+            {
+                for (std::size_t j = 0; j < i; ++j)
+                {
+                    if (conflicts(_systems[i], _systems[j]))
+                        level[i] = std::max(level[i], level[j] + 1);
+                }
+                if (level[i] >= _stages.size())
+                    _stages.resize(level[i] + 1);
+                _stages[level[i]].push_back(i);
+            }
+        }
 
     private:
-        std::unordered_map<std::type_index, std::any> _components_arrays;
-        std::unordered_map<std::type_index, std::function<void(registry &, entity_t const &)>> _erase_funcs;
-        std::vector<std::size_t> _alive;
-        std::size_t _next_entity_id{0};
-        std::vector<std::function<void(registry &)>> _systems;
+        std::vector<std::unique_ptr<pool_base>> _pools; // indexed by component_id, null if unregistered
+        std::unique_ptr<archetype_table> _archetypes = std::make_unique<archetype_table>();
+        std::vector<std::unique_ptr<view_base>> _views; // indexed by detail::view_id, null until first use
+        std::vector<bool> _alive;
+        std::vector<std::uint32_t> _generations;
+        std::vector<std::size_t> _free_indices;
+        std::vector<system_entry> _systems;
+        std::vector<std::vector<std::size_t>> _stages; // built lazily from _systems
+        command_buffer _commands;                      // commands recorded outside systems
+        thread_pool *_pool = nullptr;
+        std::size_t _reserved = 0; // entity count passed to reserve()
     };
 
 }
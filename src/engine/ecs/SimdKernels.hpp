@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ENGINE_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_SIMD_SSE 1
+#endif
+/**
+ * @file SimdKernels.hpp
+ * @brief Vectorized float kernels used by movement systems on contiguous component columns.
+ *
+ * The kernels work on plain float arrays: the x/y pairs of a position or velocity chunk column
+ * (which are laid out as x0 y0 x1 y1 ...) or per-field arrays gathered from a chunk. The
+ * instruction set is picked at compile time: AVX (8 lanes) when the build enables it (see the
+ * ENGINE_SIMD_AVX CMake option), SSE2 (4 lanes, always available on x86-64), otherwise scalar.
+ * Every kernel finishes the tail that does not fill a register with the scalar loop, so the
+ * results do not depend on the backend.
+ *
+ * No alignment is required and arrays may not overlap unless stated otherwise.
+ */
+namespace engine::simd
+{
+    constexpr const char *backend() noexcept
+    {
+#if defined(ENGINE_SIMD_AVX)
+        return "avx";
+#elif defined(ENGINE_SIMD_SSE)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    // y[i] += a * x[i]
+    inline void axpy(float *y, float const *x, float a, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+#if defined(ENGINE_SIMD_AVX)
+        const __m256 va = _mm256_set1_ps(a);
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+#elif defined(ENGINE_SIMD_SSE)
+        const __m128 va = _mm_set1_ps(a);
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+#endif
+        for (; i < n; ++i)
+            y[i] += a * x[i];
+    }
+
+    // y[i] += x[i]
+    inline void add(float *y, float const *x, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+#if defined(ENGINE_SIMD_AVX)
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+#elif defined(ENGINE_SIMD_SSE)
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+#endif
+        for (; i < n; ++i)
+            y[i] += x[i];
+    }
+
+    // xy[2i] += dx[i] * s[i], xy[2i+1] += dy[i] * s[i]  (move interleaved points along scaled directions)
+    inline void add_scaled_pairs(float *xy, float const *dx, float const *dy, float const *s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+#if defined(ENGINE_SIMD_AVX)
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 vs = _mm256_loadu_ps(s + i);
+            __m256 sx = _mm256_mul_ps(_mm256_loadu_ps(dx + i), vs);
+            __m256 sy = _mm256_mul_ps(_mm256_loadu_ps(dy + i), vs);
+            // unpack works per 128-bit lane: lo = pairs 0,1,4,5 / hi = pairs 2,3,6,7
+            __m256 lo = _mm256_unpacklo_ps(sx, sy);
+            __m256 hi = _mm256_unpackhi_ps(sx, sy);
+            __m256 first = _mm256_permute2f128_ps(lo, hi, 0x20);  // pairs 0..3
+            __m256 second = _mm256_permute2f128_ps(lo, hi, 0x31); // pairs 4..7
+            float *p = xy + 2 * i;
+            _mm256_storeu_ps(p, _mm256_add_ps(_mm256_loadu_ps(p), first));
+            _mm256_storeu_ps(p + 8, _mm256_add_ps(_mm256_loadu_ps(p + 8), second));
+        }
+#elif defined(ENGINE_SIMD_SSE)
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 vs = _mm_loadu_ps(s + i);
+            __m128 sx = _mm_mul_ps(_mm_loadu_ps(dx + i), vs);
+            __m128 sy = _mm_mul_ps(_mm_loadu_ps(dy + i), vs);
+            float *p = xy + 2 * i;
+            _mm_storeu_ps(p, _mm_add_ps(_mm_loadu_ps(p), _mm_unpacklo_ps(sx, sy)));
+            _mm_storeu_ps(p + 4, _mm_add_ps(_mm_loadu_ps(p + 4), _mm_unpackhi_ps(sx, sy)));
+        }
+#endif
+        for (float *p = xy + 2 * i; i < n; ++i, p += 2)
+        {
+            p[0] += dx[i] * s[i];
+            p[1] += dy[i] * s[i];
+        }
+    }
+
+    // xy[2i] = dx[i] * s[i], xy[2i+1] = dy[i] * s[i]  (interleaved velocities from directions)
+    inline void scale_pairs(float *xy, float const *dx, float const *dy, float const *s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+#if defined(ENGINE_SIMD_AVX)
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 vs = _mm256_loadu_ps(s + i);
+            __m256 sx = _mm256_mul_ps(_mm256_loadu_ps(dx + i), vs);
+            __m256 sy = _mm256_mul_ps(_mm256_loadu_ps(dy + i), vs);
+            __m256 lo = _mm256_unpacklo_ps(sx, sy);
+            __m256 hi = _mm256_unpackhi_ps(sx, sy);
+            _mm256_storeu_ps(xy + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(xy + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+#elif defined(ENGINE_SIMD_SSE)
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 vs = _mm_loadu_ps(s + i);
+            __m128 sx = _mm_mul_ps(_mm_loadu_ps(dx + i), vs);
+            __m128 sy = _mm_mul_ps(_mm_loadu_ps(dy + i), vs);
+            _mm_storeu_ps(xy + 2 * i, _mm_unpacklo_ps(sx, sy));
+            _mm_storeu_ps(xy + 2 * i + 4, _mm_unpackhi_ps(sx, sy));
+        }
+#endif
+        for (float *p = xy + 2 * i; i < n; ++i, p += 2)
+        {
+            p[0] = dx[i] * s[i];
+            p[1] = dy[i] * s[i];
+        }
+    }
+
+}
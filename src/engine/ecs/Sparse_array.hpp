@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <memory>
 #include <algorithm>
+#include "MembershipLog.hpp"
 /**
  * @file Sparse_array.hpp
  * @brief Defines the engine::sparse_array template class for efficient sparse storage of components.
@@ -14,6 +15,10 @@
  * This is particularly useful in Entity-Component-System (ECS) architectures where not all
  * entities have all components.
  *
+ * @note Cached views (see View.hpp) only notice components added through insert_at/emplace_at
+ *       and removed through erase; assigning or resetting the optional returned by operator[]
+ *       bypasses the membership log.
+ *
  * @tparam Component The type of component to store in the sparse array.
  */
 namespace engine
@@ -22,6 +27,7 @@ namespace engine
     class sparse_array
     {
     public:
+        using component_type = Component;
         using value_type = std::optional<Component>;
         using reference_type = value_type &;
         using const_reference_type = value_type const &;
@@ -55,11 +61,16 @@ namespace engine
         // Capacity
         size_type size() const { return _data.size(); }
 
+        // Makes room for entity indices below n without reallocating
+        void reserve(size_type n) { _data.reserve(n); }
+
         // Modifiers
         reference_type insert_at(size_type pos, Component const &c)
         {
             if (pos >= _data.size())
                 _data.resize(pos + 1);
+            if (!_data[pos])
+                _changes.record(pos);
             _data[pos] = c;
             return _data[pos];
         }
@@ -68,6 +79,8 @@ namespace engine
         {
             if (pos >= _data.size())
                 _data.resize(pos + 1);
+            if (!_data[pos])
+                _changes.record(pos);
             _data[pos] = std::move(c);
             return _data[pos];
         }
@@ -77,16 +90,25 @@ namespace engine
         {
             if (pos >= _data.size())
                 _data.resize(pos + 1);
+            if (!_data[pos])
+                _changes.record(pos);
             _data[pos].emplace(std::forward<Params>(params)...);
             return _data[pos];
         }
 
         void erase(size_type pos)
         {
-            if (pos < _data.size())
+            if (pos < _data.size() && _data[pos])
+            {
                 _data[pos] = std::nullopt;
+                _changes.record(pos);
+            }
         }
 
+        // Entity indices whose component appeared or disappeared, for cached views
+        membership_log &changes() noexcept { return _changes; }
+        membership_log const &changes() const noexcept { return _changes; }
+
         size_type get_index(value_type const &opt) const
         {
             auto it = std::find_if(_data.begin(), _data.end(), [&](auto const &v)
@@ -96,6 +118,7 @@ namespace engine
 
     private:
         container_t _data;
+        membership_log _changes;
     };
 
 }
@@ -0,0 +1,222 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include "MembershipLog.hpp"
+/**
+ * @file Sparse_set.hpp
+ * @brief Defines the engine::sparse_set template class, a packed alternative to engine::sparse_array.
+ *
+ * The sparse_set stores components contiguously in a dense array, alongside a dense list of the
+ * entity indices owning them and a sparse index (entity index -> dense slot). Lookup by entity
+ * stays O(1), insertion appends and erasure swaps the last element into the freed slot, so the
+ * dense array never contains holes. Iterating it only touches live components.
+ *
+ * Element access mirrors sparse_array: operator[] returns a lightweight optional-like slot
+ * (has_value(), value(), operator->, reset(), ...) so code written against sparse_array keeps
+ * working when a component switches storage.
+ *
+ * @note Erasing or inserting while iterating the dense array reorders it; collect the
+ *       entities first and apply the structural changes after the loop.
+ *
+ * @tparam Component The type of component to store.
+ */
+namespace engine
+{
+    template <typename Component>
+    class sparse_set
+    {
+    public:
+        using component_type = Component;
+        using container_t = std::vector<Component>;
+        using size_type = std::size_t;
+        using iterator = typename container_t::iterator;
+        using const_iterator = typename container_t::const_iterator;
+
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        /**
+         * @brief Optional-like handle on the component of one entity index.
+         *
+         * Only valid until the next structural change (insert/erase) of the owning set.
+         */
+        template <bool Const>
+        class basic_slot
+        {
+            using set_t = std::conditional_t<Const, sparse_set const, sparse_set>;
+            using ref_t = std::conditional_t<Const, Component const &, Component &>;
+            using ptr_t = std::conditional_t<Const, Component const *, Component *>;
+
+        public:
+            basic_slot(set_t &set, size_type idx) : _set(&set), _idx(idx) {}
+
+            bool has_value() const noexcept { return _set->contains(_idx); }
+            explicit operator bool() const noexcept { return has_value(); }
+
+            ref_t value() const
+            {
+                if (!has_value())
+                    throw std::bad_optional_access();
+                return _set->_dense[_set->_sparse[_idx]];
+            }
+            ref_t operator*() const { return _set->_dense[_set->_sparse[_idx]]; }
+            ptr_t operator->() const { return &**this; }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            void reset() { _set->erase(_idx); }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(std::nullopt_t)
+            {
+                _set->erase(_idx);
+                return *this;
+            }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(Component const &c)
+            {
+                _set->insert_at(_idx, c);
+                return *this;
+            }
+
+            template <bool C = Const, typename = std::enable_if_t<!C>>
+            basic_slot &operator=(Component &&c)
+            {
+                _set->insert_at(_idx, std::move(c));
+                return *this;
+            }
+
+        private:
+            set_t *_set;
+            size_type _idx;
+        };
+
+        using reference_type = basic_slot<false>;
+        using const_reference_type = basic_slot<true>;
+
+    public:
+        // Constructors
+        sparse_set() = default;
+        sparse_set(sparse_set const &) = default;
+        sparse_set(sparse_set &&) noexcept = default;
+        sparse_set &operator=(sparse_set const &) = default;
+        sparse_set &operator=(sparse_set &&) noexcept = default;
+        ~sparse_set() = default;
+
+        // Element access (by entity index)
+        reference_type operator[](size_type idx) { return reference_type(*this, idx); }
+        const_reference_type operator[](size_type idx) const { return const_reference_type(*this, idx); }
+
+        bool contains(size_type idx) const noexcept
+        {
+            return idx < _sparse.size() && _sparse[idx] != npos;
+        }
+
+        // Dense iteration: only live components, in packed order
+        iterator begin() { return _dense.begin(); }
+        const_iterator begin() const { return _dense.begin(); }
+        const_iterator cbegin() const { return _dense.cbegin(); }
+
+        iterator end() { return _dense.end(); }
+        const_iterator end() const { return _dense.end(); }
+        const_iterator cend() const { return _dense.cend(); }
+
+        // Entity index owning each dense slot (parallel to begin()/end())
+        std::vector<size_type> const &entities() const noexcept { return _entities; }
+
+        // Capacity
+        // size() keeps sparse_array semantics (one past the highest index ever used) so that
+        // `idx < arr.size() && arr[idx]` checks stay valid; dense_size() is the live count.
+        size_type size() const noexcept { return _sparse.size(); }
+        size_type dense_size() const noexcept { return _dense.size(); }
+        bool empty() const noexcept { return _dense.empty(); }
+
+        // Makes room for n components on entity indices below n without reallocating
+        void reserve(size_type n)
+        {
+            _dense.reserve(n);
+            _entities.reserve(n);
+            _sparse.reserve(n);
+        }
+
+        // Modifiers
+        reference_type insert_at(size_type pos, Component const &c)
+        {
+            if (contains(pos))
+                _dense[_sparse[pos]] = c;
+            else
+                push(pos, c);
+            return (*this)[pos];
+        }
+
+        reference_type insert_at(size_type pos, Component &&c)
+        {
+            if (contains(pos))
+                _dense[_sparse[pos]] = std::move(c);
+            else
+                push(pos, std::move(c));
+            return (*this)[pos];
+        }
+
+        template <class... Params>
+        reference_type emplace_at(size_type pos, Params &&...params)
+        {
+            if (contains(pos))
+                _dense[_sparse[pos]] = Component(std::forward<Params>(params)...);
+            else
+                push(pos, Component(std::forward<Params>(params)...));
+            return (*this)[pos];
+        }
+
+        void erase(size_type pos)
+        {
+            if (!contains(pos))
+                return;
+            size_type slot = _sparse[pos];
+            size_type last = _dense.size() - 1;
+            if (slot != last)
+            {
+                _dense[slot] = std::move(_dense[last]);
+                _entities[slot] = _entities[last];
+                _sparse[_entities[slot]] = slot;
+            }
+            _dense.pop_back();
+            _entities.pop_back();
+            _sparse[pos] = npos;
+            _changes.record(pos);
+        }
+
+        void clear()
+        {
+            for (size_type idx : _entities)
+                _changes.record(idx);
+            _dense.clear();
+            _entities.clear();
+            _sparse.clear();
+        }
+
+        // Entity indices whose component appeared or disappeared, for cached views
+        membership_log &changes() noexcept { return _changes; }
+        membership_log const &changes() const noexcept { return _changes; }
+
+    private:
+        template <typename C>
+        void push(size_type pos, C &&c)
+        {
+            if (pos >= _sparse.size())
+                _sparse.resize(pos + 1, npos);
+            _sparse[pos] = _dense.size();
+            _dense.push_back(std::forward<C>(c));
+            _entities.push_back(pos);
+            _changes.record(pos);
+        }
+
+        container_t _dense;
+        std::vector<size_type> _entities;
+        std::vector<size_type> _sparse;
+        membership_log _changes;
+    };
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <concepts>
+#include <type_traits>
+#include "Archetype.hpp"
+#include "Sparse_array.hpp"
+#include "Sparse_set.hpp"
+/**
+ * @file Storage.hpp
+ * @brief Per-component selection of the storage backend used by engine::registry.
+ *
+ * Components default to engine::sparse_array (one optional slot per entity index). A component
+ * opts into the packed engine::sparse_set by declaring a static member:
+ *
+ * @code
+ * struct area_effect
+ * {
+ *     static constexpr bool packed_storage = true;
+ *     ...
+ * };
+ * @endcode
+ *
+ * Packed storage suits components held by few or short-lived entities (projectiles, AI, effects)
+ * and bulky ones (animations): iteration only touches live components and dead entities cost a
+ * single index instead of a whole component slot.
+ *
+ * Components iterated together by hot systems (position, velocity, ...) can instead opt into
+ * archetype storage with `static constexpr bool archetype_storage = true;` (or, for types that
+ * cannot hold members such as enums, by specialising engine::archetype_storage_v). Their values
+ * live in the registry's archetype_table and are queried per chunk with
+ * registry::for_each_chunk; see Archetype.hpp.
+ */
+namespace engine
+{
+    template <class Component>
+    concept packed_component = requires {
+        { Component::packed_storage } -> std::convertible_to<bool>;
+    } && Component::packed_storage;
+
+    template <class Component>
+    concept archetype_member = requires {
+        { Component::archetype_storage } -> std::convertible_to<bool>;
+    } && Component::archetype_storage;
+
+    template <class Component>
+    inline constexpr bool archetype_storage_v = archetype_member<Component>;
+
+    template <class Component>
+    struct component_storage
+    {
+        using type = std::conditional_t<archetype_storage_v<Component>,
+                                        archetype_column<Component>,
+                                        std::conditional_t<packed_component<Component>,
+                                                           sparse_set<Component>,
+                                                           sparse_array<Component>>>;
+    };
+
+    template <class Component>
+    using storage_t = typename component_storage<Component>::type;
+
+}
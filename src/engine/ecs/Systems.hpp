@@ -1,6 +1,8 @@
 #pragma once
 #include "engine/ecs/Registry.hpp"
 #include "engine/ecs/Components.hpp"
+#include "engine/ecs/Collision.hpp"
+#include "engine/ecs/SimdKernels.hpp"
 #include "engine/ecs/iterator/Zipper.hpp"
 #include "engine/ecs/iterator/Indexed_zipper.hpp"
 #include <algorithm>
@@ -13,56 +15,106 @@ using namespace engine;
  *
  * This file implements several systems operating on ECS components:
  * - position_system: Updates entity positions based on velocity.
- * - hitbox_system: Detects collisions between entities and triggers a callback.
+ * - hitbox_system: Detects collisions between entities (uniform grid broad phase) and triggers a callback.
  * - health_system: Applies damage, updates health, and marks entities for despawn if health reaches zero.
- * - spawn_system: Handles entity spawning via factory callbacks.
+ * - spawn_system: Handles entity spawning via factory callbacks (deferred to the command buffer).
  *
- * Each system operates on sparse arrays of components and interacts with the registry.
+ * Each system operates on component storages (or on archetype chunks, see
+ * registry::for_each_chunk) and interacts with the registry.
  */
-inline void position_system(registry &r,
-                    sparse_array<component::position> &positions,
-                    sparse_array<component::velocity> &velocities,
-                    float deltaTime)
+static_assert(sizeof(component::position) == 2 * sizeof(float) && sizeof(component::velocity) == 2 * sizeof(float),
+              "movement kernels view position/velocity columns as interleaved x/y float arrays");
+
+// position and velocity are archetype-stored: integrate whole chunks as flat float arrays
+inline void position_system(registry &r, float deltaTime)
 {
-    for (auto &&[i, pos, vel] : indexed_zipper(positions, velocities))
+    r.for_each_chunk<component::position, const component::velocity>(
+        [deltaTime](std::size_t count, std::size_t const *,
+                    component::position *pos, component::velocity const *vel)
+        {
+            simd::axpy(&pos->x, &vel->vx, deltaTime, 2 * count);
+        });
+}
+
+namespace engine::detail
+{
+    inline bool hitboxes_overlap(component::position const &posA, component::hitbox const &hbA,
+                                 component::position const &posB, component::hitbox const &hbB)
     {
-        pos.x += vel.vx * deltaTime;
-        pos.y += vel.vy * deltaTime;
+        return posA.x + hbA.offset_x < posB.x + hbB.offset_x + hbB.width &&
+               posA.x + hbA.offset_x + hbA.width > posB.x + hbB.offset_x &&
+               posA.y + hbA.offset_y < posB.y + hbB.offset_y + hbB.height &&
+               posA.y + hbA.offset_y + hbA.height > posB.y + hbB.offset_y;
+    }
+
+    // layers(i, category, mask) fills the broad-phase filter bits of entity i.
+    template <typename Layers, typename Callback>
+    void run_hitbox_pairs(registry &r,
+                          storage_t<component::position> &positions,
+                          sparse_array<component::hitbox> &hitboxes,
+                          spatial_hash &grid, Layers &&layers, Callback &on_collision)
+    {
+        grid.clear();
+        r.view<const component::position, const component::hitbox>().each(
+            [&](std::size_t i, component::position const &pos, component::hitbox const &hb)
+            {
+                std::uint32_t category = ~0u, mask = ~0u;
+                layers(i, category, mask);
+                float x1 = pos.x + hb.offset_x;
+                float y1 = pos.y + hb.offset_y;
+                grid.insert(i, x1, y1, x1 + hb.width, y1 + hb.height, category, mask);
+            });
+        // Re-test against live components: earlier callbacks may have moved or killed entities.
+        grid.for_each_pair([&](std::size_t i, std::size_t j)
+        {
+            if (!positions[i] || !hitboxes[i] || !positions[j] || !hitboxes[j])
+                return;
+            if (hitboxes_overlap(*positions[i], *hitboxes[i], *positions[j], *hitboxes[j]))
+                on_collision(i, j);
+        });
     }
 }
 
+// Broad phase through `grid` (reused between calls), skipping kind pairs `matrix` does not allow.
+// on_collision(i, j) is called once per overlapping pair, with i < j.
 template <typename Callback>
 void hitbox_system(registry &r,
-                   sparse_array<component::position> &positions,
+                   storage_t<component::position> &positions,
                    sparse_array<component::hitbox> &hitboxes,
+                   storage_t<component::entity_kind> &kinds,
+                   collision_matrix const &matrix,
+                   spatial_hash &grid,
                    Callback on_collision)
 {
-    for (auto &&[i, posA, hbA] : indexed_zipper(positions, hitboxes))
-    {
-        for (std::size_t j = i + 1; j < positions.size(); ++j)
+    detail::run_hitbox_pairs(r, positions, hitboxes, grid,
+        [&](std::size_t i, std::uint32_t &category, std::uint32_t &mask)
         {
-            if (!positions[j] || !hitboxes[j])
-                continue;
-            const auto &posB = positions[j].value();
-            const auto &hbB = hitboxes[j].value();
-            if (posA.x + hbA.offset_x < posB.x + hbB.offset_x + hbB.width &&
-                posA.x + hbA.offset_x + hbA.width > posB.x + hbB.offset_x &&
-                posA.y + hbA.offset_y < posB.y + hbB.offset_y + hbB.height &&
-                posA.y + hbA.offset_y + hbA.height > posB.y + hbB.offset_y)
-            {
-                on_collision(i, j);
-            }
-        }
-    }
+            auto kind = (i < kinds.size() && kinds[i]) ? kinds[i].value() : component::entity_kind::unknown;
+            category = collision_matrix::category(kind);
+            mask = matrix.mask(kind);
+        },
+        on_collision);
+}
+
+// Every overlapping pair of hitboxes, whatever their kind.
+template <typename Callback>
+void hitbox_system(registry &r,
+                   storage_t<component::position> &positions,
+                   sparse_array<component::hitbox> &hitboxes,
+                   Callback on_collision)
+{
+    spatial_hash grid;
+    detail::run_hitbox_pairs(r, positions, hitboxes, grid,
+        [](std::size_t, std::uint32_t &, std::uint32_t &) {}, on_collision);
 }
 
-// Apply damage to health and mark entities for despawn when hp <= 0
+// Apply damage to health and kill entities when hp <= 0 (through r.commands(): outside
+// run_systems, call r.flush_commands() afterwards)
 inline void health_system(registry &r,
-                          sparse_array<component::health> &healths,
+                          sparse_array<component::health> &,
                           sparse_array<component::damage> &damages)
 {
-    std::vector<entity_t> toKill;
-    for (auto &&[i, h] : indexed_zipper(healths))
+    r.view<component::health>().each([&](std::size_t i, component::health &h)
     {
         if (i < damages.size() && damages[i] && damages[i].value().amount != 0)
         {
@@ -72,21 +124,18 @@ inline void health_system(registry &r,
             damages[i].value().amount = 0;
         }
         if (h.hp == 0)
-            toKill.push_back(r.entity_from_index(i));
-    }
-    for (auto e : toKill) r.kill_entity(e);
+            r.commands().kill(r.entity_from_index(i));
+    });
 }
 
 // Handle spawn requests via factory function
 inline void spawn_system(registry &r,
-                         sparse_array<component::spawn_request> &spawns)
+                         sparse_array<component::spawn_request> &)
 {
-    for (auto &&[i, req] : indexed_zipper(spawns))
+    r.view<component::spawn_request>().each([&](std::size_t i, component::spawn_request &req)
     {
-        auto copy = req;          // copy, as we will clear the slot
-        spawns[i] = std::nullopt; // consume request
-        auto e = r.spawn_entity();
-        if (copy.factory)
-            copy.factory(r, e);
-    }
+        if (req.factory)
+            r.commands().spawn(std::move(req.factory));
+        r.commands().remove<component::spawn_request>(r.entity_from_index(i)); // consume request
+    });
 }
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Storage.hpp"
+#include "iterator/Zipper_iterator.hpp"
+/**
+ * @file View.hpp
+ * @brief Defines engine::cached_view, a persistent query over the entities holding a set of components.
+ *
+ * A zipper walks every index below the smallest storage size (or the smallest packed entity
+ * list) each time it is iterated. A cached_view keeps its list of matching entities instead:
+ * storages record the indices whose component came or went (see MembershipLog.hpp) and the view
+ * only re-checks those when it is iterated again. A system over rare components then costs its
+ * matches plus the changes since its last run, not the entity index range.
+ *
+ * Views are owned by the registry and obtained with registry::view<Components...>(); `const
+ * Component` yields read-only access, as for systems.
+ *
+ * @note The list is brought up to date when each() starts, not during the loop: the callback
+ *       may change the current entity but must not remove components from entities it has not
+ *       visited yet (collect them and apply the changes after the loop, as with sparse_set).
+ */
+namespace engine
+{
+    class view_base
+    {
+    public:
+        virtual ~view_base() = default;
+        // Makes room for n matches on entity indices below n
+        virtual void reserve(std::size_t n) = 0;
+    };
+
+    namespace detail
+    {
+        inline std::size_t next_view_id() noexcept
+        {
+            static std::atomic<std::size_t> next{0};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Dense id per view type, indexing registry::_views like component_id does for pools
+        template <class View>
+        std::size_t view_id() noexcept
+        {
+            static const std::size_t id = next_view_id();
+            return id;
+        }
+    }
+
+    template <class... Components>
+    class cached_view final : public view_base
+    {
+        template <class Component>
+        using storage_ptr = std::conditional_t<std::is_const_v<Component>,
+                                               storage_t<std::remove_const_t<Component>> const *,
+                                               storage_t<Component> *>;
+
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        explicit cached_view(storage_ptr<Components>... storages) : _storages(storages...) {}
+
+        cached_view(cached_view const &) = delete;
+        cached_view &operator=(cached_view const &) = delete;
+
+        /**
+         * @brief Calls f(idx, components...) for every entity index holding all of Components.
+         */
+        template <typename Function>
+        void each(Function &&f)
+        {
+            refresh();
+            for (std::size_t idx : _entities)
+                invoke(f, idx, std::index_sequence_for<Components...>{});
+        }
+
+        // Matching entity indices, in no particular order
+        std::vector<std::size_t> const &entities()
+        {
+            refresh();
+            return _entities;
+        }
+
+        std::size_t size() { return entities().size(); }
+
+        void reserve(std::size_t n) override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _entities.reserve(n);
+            _slots.reserve(n);
+        }
+
+        // Applies the membership changes recorded since the last call. Safe to call from
+        // concurrent readers of the same components (parallel systems sharing the view).
+        void refresh()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_built || !replay(std::index_sequence_for<Components...>{}))
+                rebuild(std::index_sequence_for<Components...>{});
+        }
+
+    private:
+        template <typename Function, std::size_t... Is>
+        void invoke(Function &f, std::size_t idx, std::index_sequence<Is...>)
+        {
+            f(idx, *(*std::get<Is>(_storages))[idx]...);
+        }
+
+        template <std::size_t... Is>
+        bool matches(std::size_t idx, std::index_sequence<Is...>) const
+        {
+            return (... && (idx < std::get<Is>(_storages)->size() && (*std::get<Is>(_storages))[idx].has_value()));
+        }
+
+        void update(std::size_t idx)
+        {
+            bool listed = idx < _slots.size() && _slots[idx] != npos;
+            bool match = matches(idx, std::index_sequence_for<Components...>{});
+            if (match && !listed)
+                add(idx);
+            else if (!match && listed)
+            {
+                std::size_t slot = _slots[idx];
+                _entities[slot] = _entities.back();
+                _slots[_entities[slot]] = slot;
+                _entities.pop_back();
+                _slots[idx] = npos;
+            }
+        }
+
+        void add(std::size_t idx)
+        {
+            if (idx >= _slots.size())
+                _slots.resize(idx + 1, npos);
+            _slots[idx] = _entities.size();
+            _entities.push_back(idx);
+        }
+
+        // false when a log dropped records this view had not seen, so the list must be rebuilt
+        template <std::size_t... Is>
+        bool replay(std::index_sequence<Is...>)
+        {
+            bool complete = (... && std::get<Is>(_storages)->changes().replay(_seen[Is], [this](std::size_t idx)
+                                                                          { update(idx); }));
+            if (complete)
+                ((_seen[Is] = std::get<Is>(_storages)->changes().version()), ...);
+            return complete;
+        }
+
+        // Full scan, driven by the smallest packed entity list when there is one
+        template <std::size_t... Is>
+        void rebuild(std::index_sequence<Is...>)
+        {
+            _entities.clear();
+            std::fill(_slots.begin(), _slots.end(), npos);
+            std::vector<std::size_t> const *driver = detail::pick_driver(*std::get<Is>(_storages)...);
+            if (driver)
+            {
+                for (std::size_t idx : *driver)
+                {
+                    if (matches(idx, std::index_sequence<Is...>{}))
+                        add(idx);
+                }
+            }
+            else
+            {
+                std::size_t bound = std::min({std::get<Is>(_storages)->size()...});
+                for (std::size_t idx = 0; idx < bound; ++idx)
+                {
+                    if (matches(idx, std::index_sequence<Is...>{}))
+                        add(idx);
+                }
+            }
+            ((_seen[Is] = std::get<Is>(_storages)->changes().version()), ...);
+            _built = true;
+        }
+
+        std::tuple<storage_ptr<Components>...> _storages;
+        std::vector<std::size_t> _entities;            // matching entity indices
+        std::vector<std::size_t> _slots;               // entity index -> position in _entities, npos if absent
+        std::size_t _seen[sizeof...(Components)] = {}; // log version of each storage already applied
+        bool _built = false;
+        std::mutex _mutex;
+    };
+
+}
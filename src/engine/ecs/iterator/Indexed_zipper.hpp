@@ -17,14 +17,18 @@ namespace engine
         indexed_zipper(Containers &...cs) : _containers(&cs...)
         {
             _max = std::min({cs.size()...});
+            _driver = detail::pick_driver(cs...);
         }
 
-        iterator begin() { return iterator(_containers, 0, _max); }
-        iterator end() { return iterator(_containers, _max, _max); }
+        iterator begin() { return iterator(_containers, 0, _max, _driver); }
+        iterator end() { return iterator(_containers, end_pos(), _max, _driver); }
 
     private:
         std::tuple<Containers *...> _containers;
         std::size_t _max;
+        std::vector<std::size_t> const *_driver;
+
+        std::size_t end_pos() const { return _driver ? _driver->size() : _max; }
     };
 
 }
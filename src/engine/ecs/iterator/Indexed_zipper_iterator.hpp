@@ -20,8 +20,9 @@ namespace engine
 
         indexed_zipper_iterator(std::tuple<Containers *...> containers,
                                 std::size_t idx,
-                                std::size_t max)
-            : base(containers, idx, max) {}
+                                std::size_t max,
+                                std::vector<std::size_t> const *driver = nullptr)
+            : base(containers, idx, max, driver) {}
 
         value_type operator*()
         {
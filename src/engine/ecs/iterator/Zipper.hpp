@@ -26,13 +26,17 @@ namespace engine
         zipper(Containers &...cs) : _containers(&cs...)
         {
             _max = std::min({cs.size()...});
+            _driver = detail::pick_driver(cs...);
         }
 
-        iterator begin() { return {_containers, 0, _max}; }
-        iterator end() { return {_containers, _max, _max}; }
+        iterator begin() { return {_containers, 0, _max, _driver}; }
+        iterator end() { return {_containers, end_pos(), _max, _driver}; }
 
     private:
         std::tuple<Containers *...> _containers;
         std::size_t _max;
+        std::vector<std::size_t> const *_driver;
+
+        std::size_t end_pos() const { return _driver ? _driver->size() : _max; }
     };
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 #include <tuple>
+#include <type_traits>
 #include <optional>
 #include <cstddef>
+#include <vector>
 
 /**
  * @file Zipper_iterator.hpp
@@ -20,9 +22,12 @@
  * - At each valid position, dereferencing the iterator yields a tuple of references to the values in each container.
  * - The iterator automatically skips indices where any container's element is not set (i.e., has_value() is false).
  * - The containers are expected to store elements of type std::optional<T>, and the value_type is a tuple of references to the contained values.
+ * - When a driver list is given (the dense entity list of a packed engine::sparse_set), the iterator walks
+ *   that list instead of every index in [0, max), so joins cost the size of the smallest packed container.
  *
  * @note
- * - The containers must support operator[] and return std::optional for their elements.
+ * - The containers must expose `component_type` and their operator[] must return an optional-like value
+ *   (has_value()/value()), as engine::sparse_array and engine::sparse_set do.
  * - The iterator is not a standard STL iterator, but provides similar semantics for use in range-based loops or manual iteration.
  *
  * @example
@@ -43,14 +48,18 @@ namespace engine
     template <class... Containers>
     class zipper_iterator
     {
+        // Const containers (read-only system parameters) yield const references
         template <class Container>
-        using ref_t = typename Container::value_type::value_type &;
+        using ref_t = std::conditional_t<std::is_const_v<Container>,
+                                         typename Container::component_type const &,
+                                         typename Container::component_type &>;
 
     public:
         using value_type = std::tuple<ref_t<Containers>...>;
 
-        zipper_iterator(std::tuple<Containers *...> containers, std::size_t idx, std::size_t max)
-            : _containers(containers), _index(idx), _max(max)
+        zipper_iterator(std::tuple<Containers *...> containers, std::size_t idx, std::size_t max,
+                        std::vector<std::size_t> const *driver = nullptr)
+            : _containers(containers), _index(idx), _max(max), _driver(driver), _pos(idx)
         {
             skip_invalid();
         }
@@ -59,12 +68,13 @@ namespace engine
 
         zipper_iterator &operator++()
         {
-            _index++;
+            _pos++;
             skip_invalid();
             return *this;
         }
 
-        bool operator!=(const zipper_iterator &other) const { return _index != other._index; }
+        // Also stops once exhausted, in case the driver list shrank during iteration.
+        bool operator!=(const zipper_iterator &other) const { return _index < _max && _pos < other._pos; }
 
     private:
         template <std::size_t... Is>
@@ -81,15 +91,42 @@ namespace engine
 
         void skip_invalid()
         {
-            while (_index < _max && !all_set(std::index_sequence_for<Containers...>{}))
+            std::size_t end = _driver ? _driver->size() : _max;
+            while (_pos < end)
             {
-                _index++;
+                _index = _driver ? (*_driver)[_pos] : _pos;
+                if (_index < _max && all_set(std::index_sequence_for<Containers...>{}))
+                    return;
+                _pos++;
             }
+            _index = _max;
         }
 
     protected:
         std::tuple<Containers *...> _containers;
         std::size_t _index;
         std::size_t _max;
+        std::vector<std::size_t> const *_driver;
+        std::size_t _pos;
     };
+
+    namespace detail
+    {
+        // Picks the dense entity list of the smallest packed container among `cs`, if any.
+        template <class... Containers>
+        std::vector<std::size_t> const *pick_driver(Containers &...cs)
+        {
+            std::vector<std::size_t> const *driver = nullptr;
+            auto consider = [&](auto &c)
+            {
+                if constexpr (requires { c.entities(); })
+                {
+                    if (!driver || c.entities().size() < driver->size())
+                        driver = &c.entities();
+                }
+            };
+            (consider(cs), ...);
+            return driver;
+        }
+    }
 }
@@ -0,0 +1,115 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+/**
+ * @file BumpArena.hpp
+ * @brief Defines engine::bump_arena, a linear allocator for short-lived objects freed all at once.
+ *
+ * Allocation bumps an offset inside the current block and only falls back to the heap when no
+ * block has room left. reset() makes every block available again without returning them, so an
+ * arena reused for the same workload (one tick, one flush) stops allocating once it has grown
+ * to fit it.
+ *
+ * The arena never runs destructors: objects holding resources must be destroyed by their owner
+ * before reset() (see engine::command_buffer).
+ */
+namespace engine
+{
+    class bump_arena
+    {
+    public:
+        static constexpr std::size_t default_block_size = 16 * 1024;
+
+        explicit bump_arena(std::size_t blockSize = default_block_size) : _blockSize(blockSize) {}
+
+        bump_arena(bump_arena const &) = delete;
+        bump_arena &operator=(bump_arena const &) = delete;
+        bump_arena(bump_arena &&) noexcept = default;
+        bump_arena &operator=(bump_arena &&) noexcept = default;
+
+        // `align` must be a power of two
+        void *allocate(std::size_t size, std::size_t align = alignof(std::max_align_t))
+        {
+            for (;;)
+            {
+                if (_current < _blocks.size())
+                {
+                    block &b = _blocks[_current];
+                    auto base = reinterpret_cast<std::uintptr_t>(b.data.get());
+                    std::size_t offset = ((base + _offset + align - 1) & ~(align - 1)) - base;
+                    if (offset + size <= b.size)
+                    {
+                        _offset = offset + size;
+                        return b.data.get() + offset;
+                    }
+                    ++_current;
+                    _offset = 0;
+                    continue;
+                }
+                std::size_t blockSize = std::max(_blockSize, size + align);
+                _blocks.push_back(block{std::make_unique<std::byte[]>(blockSize), blockSize});
+            }
+        }
+
+        template <class T, class... Args>
+        T *create(Args &&...args)
+        {
+            return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // `n` value-initialised T (zeroed flags, counters...), valid until the next reset()
+        template <class T>
+        T *create_array(std::size_t n)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "the arena never runs destructors");
+            T *first = static_cast<T *>(allocate(sizeof(T) * std::max<std::size_t>(n, 1), alignof(T)));
+            std::uninitialized_value_construct_n(first, n);
+            return first;
+        }
+
+        // Allocates blocks up front so that `bytes` in total are available before the heap is hit
+        void reserve(std::size_t bytes)
+        {
+            std::size_t total = capacity();
+            if (total >= bytes)
+                return;
+            std::size_t blockSize = std::max(_blockSize, bytes - total);
+            _blocks.push_back(block{std::make_unique<std::byte[]>(blockSize), blockSize});
+        }
+
+        // Makes all memory available again; blocks are kept for the next round.
+        void reset() noexcept
+        {
+            _current = 0;
+            _offset = 0;
+        }
+
+        // Bytes reserved from the heap so far
+        std::size_t capacity() const noexcept
+        {
+            std::size_t total = 0;
+            for (auto const &b : _blocks)
+                total += b.size;
+            return total;
+        }
+
+    private:
+        struct block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size = 0;
+        };
+
+        std::vector<block> _blocks;
+        std::size_t _current = 0; // block being filled
+        std::size_t _offset = 0;  // first free byte in _blocks[_current]
+        std::size_t _blockSize;
+    };
+
+}
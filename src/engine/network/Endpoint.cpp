@@ -0,0 +1,45 @@
+#include "engine/network/Endpoint.hpp"
+
+#include <asio.hpp>
+
+namespace engine::net
+{
+
+    Endpoint make_endpoint(const std::string &addr, unsigned short p)
+    {
+        const auto address = asio::ip::make_address(addr);
+        Endpoint ep;
+        ep.port = p;
+        if (address.is_v4())
+        {
+            const auto b = address.to_v4().to_bytes();
+            std::memcpy(ep.bytes.data(), b.data(), b.size());
+        }
+        else
+        {
+            const auto b = address.to_v6().to_bytes();
+            std::memcpy(ep.bytes.data(), b.data(), b.size());
+            ep.v6 = true;
+        }
+        return ep;
+    }
+
+    std::string to_string(const Endpoint &endpoint)
+    {
+        std::string text;
+        if (endpoint.v6)
+        {
+            asio::ip::address_v6::bytes_type b;
+            std::memcpy(b.data(), endpoint.bytes.data(), b.size());
+            text = "[" + asio::ip::address_v6(b).to_string() + "]";
+        }
+        else
+        {
+            asio::ip::address_v4::bytes_type b;
+            std::memcpy(b.data(), endpoint.bytes.data(), b.size());
+            text = asio::ip::address_v4(b).to_string();
+        }
+        return text + ":" + std::to_string(endpoint.port);
+    }
+
+} // namespace engine::net
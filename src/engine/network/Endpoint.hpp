@@ -1,24 +1,47 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <string>
 
 namespace engine::net
 {
 
-    // Simple value type representing a UDP endpoint without exposing Asio.
+    // Value type representing a UDP endpoint without exposing Asio. The address is kept in
+    // binary form (IPv4 in the first 4 bytes, or IPv6) so that packets can be matched,
+    // hashed and sent without formatting or parsing strings; to_string() is for logging.
     struct Endpoint
     {
-        std::string address; // IPv4/IPv6 textual address
-        unsigned short port{};
-        bool operator==(const Endpoint &other) const
-        {
-            return address == other.address && port == other.port;
-        }
+        std::array<std::uint8_t, 16> bytes{};
+        std::uint16_t port{};
+        bool v6 = false;
+
+        bool operator==(const Endpoint &other) const = default;
     };
 
-    inline Endpoint make_endpoint(const std::string &addr, unsigned short p)
-    {
-        return Endpoint{addr, p};
-    }
+    // Parses a textual IPv4/IPv6 address; throws std::system_error if it is malformed
+    Endpoint make_endpoint(const std::string &addr, unsigned short p);
+
+    // "address:port", for logs
+    std::string to_string(const Endpoint &endpoint);
 
 } // namespace engine::net
+
+template <>
+struct std::hash<engine::net::Endpoint>
+{
+    std::size_t operator()(const engine::net::Endpoint &e) const noexcept
+    {
+        std::uint64_t lo, hi;
+        std::memcpy(&lo, e.bytes.data(), sizeof(lo));
+        std::memcpy(&hi, e.bytes.data() + sizeof(lo), sizeof(hi));
+        // Fold into one word, then a splitmix64 finalizer spreads ports and addresses alike
+        std::uint64_t h = lo ^ (hi * 0x9E3779B97F4A7C15ull) ^ (std::uint64_t{e.port} << 32) ^ (e.v6 ? 1u : 0u);
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<std::size_t>(h ^ (h >> 31));
+    }
+};
@@ -2,35 +2,233 @@
 
 #include <asio.hpp>
 #include "engine/network/detail/IoContextInternal.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
 #include <cstring>
+#include <mutex>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/socket.h>
+#endif
 
 namespace engine::net
 {
 
+    // Binary conversions both ways: no address formatting or parsing per packet
     static asio::ip::udp::endpoint to_asio_endpoint(const Endpoint &ep)
     {
-        return asio::ip::udp::endpoint(asio::ip::make_address(ep.address), ep.port);
+        if (ep.v6)
+        {
+            asio::ip::address_v6::bytes_type b;
+            std::memcpy(b.data(), ep.bytes.data(), b.size());
+            return asio::ip::udp::endpoint(asio::ip::address_v6(b), ep.port);
+        }
+        asio::ip::address_v4::bytes_type b;
+        std::memcpy(b.data(), ep.bytes.data(), b.size());
+        return asio::ip::udp::endpoint(asio::ip::address_v4(b), ep.port);
     }
 
     static Endpoint from_asio_endpoint(const asio::ip::udp::endpoint &ep)
     {
-        return Endpoint{ep.address().to_string(), ep.port()};
+        Endpoint out;
+        out.port = ep.port();
+        const auto address = ep.address();
+        if (address.is_v4())
+        {
+            const auto b = address.to_v4().to_bytes();
+            std::memcpy(out.bytes.data(), b.data(), b.size());
+        }
+        else
+        {
+            const auto b = address.to_v6().to_bytes();
+            std::memcpy(out.bytes.data(), b.data(), b.size());
+            out.v6 = true;
+        }
+        return out;
     }
 
     class UdpSocketImpl
     {
     public:
         explicit UdpSocketImpl(IoContext &io, unsigned short port)
-            : socket(*static_cast<asio::io_context *>(io.native_handle()),
-                     asio::ip::udp::endpoint(asio::ip::udp::v4(), port))
+            : ctx(*static_cast<asio::io_context *>(io.native_handle())),
+              socket(ctx, asio::ip::udp::endpoint(asio::ip::udp::v4(), port))
         {
             socket.non_blocking(true);
+            ring.resize(UdpSocket::batch_size);
+            ringFrom.resize(UdpSocket::batch_size);
+            ringSize.resize(UdpSocket::batch_size);
+            batch.resize(UdpSocket::batch_size);
+            assembled.resize(UdpSocket::batch_size);
         }
 
+        static constexpr std::size_t max_udp = 1500;
+
+        // Message being reassembled from FRAGMENT packets
+        struct Partial
+        {
+            Endpoint from;
+            std::uint16_t messageId = 0;
+            std::uint8_t innerType = 0;
+            std::uint32_t seq = 0;
+            std::uint16_t received = 0;
+            std::vector<bool> have;
+            std::vector<std::uint8_t> data;
+            std::chrono::steady_clock::time_point started;
+        };
+        static constexpr std::size_t max_partials = 16;
+        static constexpr std::size_t max_partials_per_sender = 2; // one sender cannot evict the others
+
+        asio::io_context &ctx;
         asio::ip::udp::socket socket;
+        std::vector<Partial> partials;
+
+        // Send side, guarded by sendMutex so rooms ticking on worker threads can share the socket
+        std::mutex sendMutex;
+        std::uint16_t nextMessageId = 0;
+
+        // Batched receive: raw datagrams of the last read, then the messages handed out
+        std::vector<std::array<std::uint8_t, max_udp>> ring;
+        std::vector<asio::ip::udp::endpoint> ringFrom;
+        std::vector<std::size_t> ringSize;
+        std::vector<UdpSocket::Datagram> batch;
+        std::vector<std::vector<std::uint8_t>> assembled; // reassembled messages of the batch
+
+        // Never throws: rooms send from pool workers, where an exception would end the tick. A
+        // full send buffer drops the datagram, as the network would.
+        template <typename ConstBufferSequence>
+        void send_to(const ConstBufferSequence &buffers, const asio::ip::udp::endpoint &to)
+        {
+            asio::error_code ec;
+            socket.send_to(buffers, to, 0, ec);
+            if (ec && ec != asio::error::would_block && ec != asio::error::try_again)
+                std::cerr << "UDP send error: " << ec.message() << "\n";
+        }
+
+        void send_to(const void *data, std::size_t size, const asio::ip::udp::endpoint &to)
+        {
+            send_to(asio::buffer(data, size), to);
+        }
+
+        std::optional<std::pair<PacketHeader, std::vector<std::uint8_t>>>
+        reassemble(const PacketHeader &hdr, const std::uint8_t *payload, std::size_t size,
+                   const Endpoint &from);
+
+        // Fills the ring; returns the number of datagrams read (0 when none is pending)
+        std::size_t read_ring();
     };
 
+    std::size_t UdpSocketImpl::read_ring()
+    {
+#if defined(__linux__)
+        std::array<mmsghdr, UdpSocket::batch_size> msgs{};
+        std::array<iovec, UdpSocket::batch_size> iov{};
+        for (std::size_t i = 0; i < UdpSocket::batch_size; ++i)
+        {
+            iov[i].iov_base = ring[i].data();
+            iov[i].iov_len = ring[i].size();
+            msgs[i].msg_hdr.msg_name = ringFrom[i].data();
+            msgs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(ringFrom[i].capacity());
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = ::recvmmsg(socket.native_handle(), msgs.data(), static_cast<unsigned>(msgs.size()),
+                           MSG_DONTWAIT, nullptr);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                std::cerr << "UDP receive error: " << std::strerror(errno) << "\n";
+            return 0;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            ringSize[i] = msgs[i].msg_len;
+            ringFrom[i].resize(msgs[i].msg_hdr.msg_namelen);
+        }
+        return static_cast<std::size_t>(n);
+#else
+        std::size_t n = 0;
+        while (n < UdpSocket::batch_size)
+        {
+            asio::error_code ec;
+            ringSize[n] = socket.receive_from(asio::buffer(ring[n]), ringFrom[n], 0, ec);
+            if (ec)
+            {
+                if (ec != asio::error::would_block && ec != asio::error::try_again)
+                    std::cerr << "UDP receive error: " << ec.message() << "\n";
+                break;
+            }
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    std::optional<std::pair<PacketHeader, std::vector<std::uint8_t>>>
+    UdpSocketImpl::reassemble(const PacketHeader &hdr, const std::uint8_t *payload, std::size_t size,
+                              const Endpoint &from)
+    {
+        if (size < sizeof(FragmentHeader))
+            return std::nullopt;
+        FragmentHeader fh{};
+        std::memcpy(&fh, payload, sizeof(FragmentHeader));
+        const std::uint8_t *chunk = payload + sizeof(FragmentHeader);
+        const std::size_t chunkSize = size - sizeof(FragmentHeader);
+        const std::size_t offset = static_cast<std::size_t>(fh.index) * UdpSocket::fragment_payload;
+        // Sizes come from the network: bound them before allocating the message
+        if (fh.count == 0 || fh.count > UdpSocket::max_fragments || fh.index >= fh.count ||
+            fh.totalSize > UdpSocket::max_message ||
+            fh.totalSize > static_cast<std::size_t>(fh.count) * UdpSocket::fragment_payload ||
+            offset + chunkSize > fh.totalSize)
+            return std::nullopt;
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto timeout = std::chrono::milliseconds(UdpSocket::reassembly_timeout_ms);
+        partials.erase(std::remove_if(partials.begin(), partials.end(),
+                                      [&](const Partial &p) { return now - p.started > timeout; }),
+                       partials.end());
+
+        auto it = std::find_if(partials.begin(), partials.end(), [&](const Partial &p)
+                               { return p.messageId == fh.messageId && p.from == from; });
+        if (it == partials.end())
+        {
+            // Oldest first: the sender's own when it has too many, anyone's when the table is full
+            auto own = std::find_if(partials.begin(), partials.end(), [&](const Partial &p)
+                                    { return p.from == from; });
+            if (own != partials.end() &&
+                static_cast<std::size_t>(std::count_if(partials.begin(), partials.end(), [&](const Partial &p)
+                                                       { return p.from == from; })) >= max_partials_per_sender)
+                partials.erase(own);
+            else if (partials.size() >= max_partials)
+                partials.erase(partials.begin());
+            Partial p;
+            p.from = from;
+            p.messageId = fh.messageId;
+            p.innerType = fh.innerType;
+            p.seq = hdr.seq;
+            p.have.assign(fh.count, false);
+            p.data.resize(fh.totalSize);
+            p.started = now;
+            partials.push_back(std::move(p));
+            it = partials.end() - 1;
+        }
+        if (it->have.size() != fh.count || it->data.size() != fh.totalSize || it->have[fh.index])
+            return std::nullopt;
+
+        std::memcpy(it->data.data() + offset, chunk, chunkSize);
+        it->have[fh.index] = true;
+        if (++it->received < fh.count)
+            return std::nullopt;
+
+        PacketHeader full{it->innerType, static_cast<std::uint16_t>(it->data.size()), it->seq};
+        std::vector<std::uint8_t> data = std::move(it->data);
+        partials.erase(it);
+        return std::make_optional(std::make_pair(full, std::move(data)));
+    }
+
     UdpSocket::UdpSocket(IoContext &ctx, unsigned short localPort)
         : _impl(std::make_unique<UdpSocketImpl>(ctx, localPort))
     {
@@ -43,44 +241,253 @@ namespace engine::net
 
     void UdpSocket::sendRaw(const void *data, std::size_t size, const Endpoint &endpoint)
     {
-        _impl->socket.send_to(asio::buffer(data, size), to_asio_endpoint(endpoint));
+        const auto to = to_asio_endpoint(endpoint);
+        std::lock_guard<std::mutex> lock(_impl->sendMutex);
+        _impl->send_to(data, size, to);
+    }
+
+    void UdpSocket::send(const PacketHeader &header, Bytes payload, const Endpoint &endpoint)
+    {
+        send_parts(header, &payload, 1, endpoint);
     }
 
-    void UdpSocket::send(const PacketHeader &header, const std::vector<std::uint8_t> &payload,
+    void UdpSocket::send(const PacketHeader &header, std::initializer_list<Bytes> parts,
                          const Endpoint &endpoint)
     {
-        std::vector<std::uint8_t> buffer(sizeof(PacketHeader) + payload.size());
-        std::memcpy(buffer.data(), &header, sizeof(PacketHeader));
-        if (!payload.empty())
-            std::memcpy(buffer.data() + sizeof(PacketHeader), payload.data(), payload.size());
-        sendRaw(buffer.data(), buffer.size(), endpoint);
+        if (parts.size() > max_send_parts)
+        {
+            std::cerr << "UDP send: more than " << max_send_parts << " payload parts\n";
+            return;
+        }
+        send_parts(header, parts.begin(), parts.size(), endpoint);
+    }
+
+    void UdpSocket::send_parts(const PacketHeader &header, const Bytes *parts, std::size_t count,
+                               const Endpoint &endpoint)
+    {
+        std::size_t total = 0;
+        for (std::size_t k = 0; k < count; ++k)
+            total += parts[k].size();
+
+        // Header(s) then the payload slice [offset, offset + size) across the parts; unused
+        // entries stay empty so the sequence has a fixed type
+        std::array<asio::const_buffer, max_send_parts + 2> buffers{};
+        auto gather = [&](std::size_t first, std::size_t offset, std::size_t size)
+        {
+            for (std::size_t k = 0; k < count && size > 0; ++k)
+            {
+                if (offset >= parts[k].size())
+                {
+                    offset -= parts[k].size();
+                    continue;
+                }
+                const std::size_t n = std::min(size, parts[k].size() - offset);
+                buffers[first++] = asio::buffer(parts[k].data() + offset, n);
+                offset = 0;
+                size -= n;
+            }
+        };
+
+        const auto to = to_asio_endpoint(endpoint);
+        if (sizeof(PacketHeader) + total <= max_datagram)
+        {
+            buffers[0] = asio::buffer(&header, sizeof(PacketHeader));
+            gather(1, 0, total);
+            std::lock_guard<std::mutex> lock(_impl->sendMutex);
+            _impl->send_to(buffers, to);
+            return;
+        }
+
+        const std::size_t fragments = (total + fragment_payload - 1) / fragment_payload;
+        if (total > max_message)
+        {
+            std::cerr << "UDP send: message of " << total << " bytes is too large\n";
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_impl->sendMutex);
+        FragmentHeader fh{_impl->nextMessageId++, 0, static_cast<std::uint16_t>(fragments),
+                          header.type, static_cast<std::uint32_t>(total)};
+        for (std::size_t i = 0; i < fragments; ++i)
+        {
+            const std::size_t offset = i * fragment_payload;
+            const std::size_t chunk = std::min(fragment_payload, total - offset);
+            fh.index = static_cast<std::uint16_t>(i);
+            PacketHeader fragHdr{FRAGMENT, static_cast<std::uint16_t>(sizeof(FragmentHeader) + chunk),
+                                 header.seq};
+            buffers.fill(asio::const_buffer{});
+            buffers[0] = asio::buffer(&fragHdr, sizeof(PacketHeader));
+            buffers[1] = asio::buffer(&fh, sizeof(FragmentHeader));
+            gather(2, offset, chunk);
+            _impl->send_to(buffers, to);
+        }
     }
 
     std::optional<std::pair<PacketHeader, std::vector<std::uint8_t>>>
     UdpSocket::receive(Endpoint &sender)
     {
         std::array<std::uint8_t, 1500> buf{};
-        asio::ip::udp::endpoint from;
-        asio::error_code ec;
-        std::size_t bytes = _impl->socket.receive_from(asio::buffer(buf), from, 0, ec);
-
-        if (ec)
+        for (;;)
         {
-            if (ec == asio::error::would_block || ec == asio::error::try_again)
+            asio::ip::udp::endpoint from;
+            asio::error_code ec;
+            std::size_t bytes = _impl->socket.receive_from(asio::buffer(buf), from, 0, ec);
+
+            if (ec)
+            {
+                if (ec == asio::error::would_block || ec == asio::error::try_again)
+                    return std::nullopt;
+                std::cerr << "UDP receive error: " << ec.message() << "\n";
                 return std::nullopt;
-            std::cerr << "UDP receive error: " << ec.message() << "\n";
-            return std::nullopt;
+            }
+            if (bytes < sizeof(PacketHeader))
+                continue;
+
+            sender = from_asio_endpoint(from);
+            PacketHeader hdr{};
+            std::memcpy(&hdr, buf.data(), sizeof(PacketHeader));
+            if (hdr.type == FRAGMENT)
+            {
+                // Keep draining until a message completes or the socket is empty
+                auto msg = _impl->reassemble(hdr, buf.data() + sizeof(PacketHeader),
+                                             bytes - sizeof(PacketHeader), sender);
+                if (msg)
+                    return msg;
+                continue;
+            }
+            std::vector<std::uint8_t> payload(bytes - sizeof(PacketHeader));
+            if (!payload.empty())
+                std::memcpy(payload.data(), buf.data() + sizeof(PacketHeader), payload.size());
+            return std::make_optional(std::make_pair(hdr, std::move(payload)));
         }
-        if (bytes < sizeof(PacketHeader))
-            return std::nullopt;
+    }
+
+    std::span<const UdpSocket::Datagram> UdpSocket::receive_batch()
+    {
+        auto &impl = *_impl;
+        std::size_t count = 0;
+        // A read made only of incomplete fragments yields nothing: read again until a message
+        // is ready or the socket is drained
+        while (count == 0)
+        {
+            const std::size_t n = impl.read_ring();
+            if (n == 0)
+                break;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (impl.ringSize[i] < sizeof(PacketHeader))
+                    continue;
+                Datagram &d = impl.batch[count];
+                d.sender = from_asio_endpoint(impl.ringFrom[i]);
+                std::memcpy(&d.header, impl.ring[i].data(), sizeof(PacketHeader));
+                const std::uint8_t *payload = impl.ring[i].data() + sizeof(PacketHeader);
+                const std::size_t size = impl.ringSize[i] - sizeof(PacketHeader);
+                if (d.header.type == FRAGMENT)
+                {
+                    auto msg = impl.reassemble(d.header, payload, size, d.sender);
+                    if (!msg)
+                        continue;
+                    d.header = msg->first;
+                    impl.assembled[count] = std::move(msg->second);
+                    d.payload = Bytes(impl.assembled[count]);
+                }
+                else
+                {
+                    d.payload = Bytes(payload, size);
+                }
+                ++count;
+            }
+        }
+        return std::span<const Datagram>(impl.batch.data(), count);
+    }
 
-        sender = from_asio_endpoint(from);
-        PacketHeader hdr{};
-        std::memcpy(&hdr, buf.data(), sizeof(PacketHeader));
-        std::vector<std::uint8_t> payload(bytes - sizeof(PacketHeader));
-        if (!payload.empty())
-            std::memcpy(payload.data(), buf.data() + sizeof(PacketHeader), payload.size());
-        return std::make_optional(std::make_pair(hdr, std::move(payload)));
+    void UdpSocket::send_batch(std::span<const OutgoingDatagram> datagrams)
+    {
+#if defined(__linux__)
+        std::array<mmsghdr, batch_size> msgs;
+        std::array<iovec, 2 * batch_size> iov;
+        std::array<asio::ip::udp::endpoint, batch_size> to;
+        std::size_t next = 0;
+        while (next < datagrams.size())
+        {
+            // Oversized messages go out through the fragmenting send() in their turn: one at the
+            // head is sent alone, one further down ends the batch so the queued ones leave first
+            if (sizeof(PacketHeader) + datagrams[next].payload.size() > max_datagram)
+            {
+                const OutgoingDatagram &d = datagrams[next++];
+                send(d.header, d.payload, *d.to);
+                continue;
+            }
+            std::size_t n = 0;
+            for (; next < datagrams.size() && n < batch_size; ++next)
+            {
+                const OutgoingDatagram &d = datagrams[next];
+                if (sizeof(PacketHeader) + d.payload.size() > max_datagram)
+                    break;
+                to[n] = to_asio_endpoint(*d.to);
+                iov[2 * n].iov_base = const_cast<PacketHeader *>(&d.header);
+                iov[2 * n].iov_len = sizeof(PacketHeader);
+                iov[2 * n + 1].iov_base = const_cast<std::uint8_t *>(d.payload.data());
+                iov[2 * n + 1].iov_len = d.payload.size();
+                msgs[n] = mmsghdr{};
+                msgs[n].msg_hdr.msg_name = to[n].data();
+                msgs[n].msg_hdr.msg_namelen = static_cast<socklen_t>(to[n].size());
+                msgs[n].msg_hdr.msg_iov = &iov[2 * n];
+                msgs[n].msg_hdr.msg_iovlen = 2;
+                ++n;
+            }
+            std::lock_guard<std::mutex> lock(_impl->sendMutex);
+            for (std::size_t sent = 0; sent < n;)
+            {
+                int r = ::sendmmsg(_impl->socket.native_handle(), msgs.data() + sent,
+                                   static_cast<unsigned>(n - sent), 0);
+                if (r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    // A full send buffer drops the rest of the batch, as the network would
+                    if (errno == EAGAIN || errno == EWOULDBLOCK)
+                        break;
+                    // Any other error belongs to the first datagram left (its size, or an ICMP
+                    // error from its client): skip it and keep sending to the others
+                    std::cerr << "UDP send error: " << std::strerror(errno) << "\n";
+                    sent += 1;
+                    continue;
+                }
+                sent += static_cast<std::size_t>(r);
+            }
+        }
+#else
+        for (const OutgoingDatagram &d : datagrams)
+            send(d.header, d.payload, *d.to);
+#endif
+    }
+
+    bool UdpSocket::wait_readable(std::chrono::steady_clock::time_point deadline)
+    {
+        asio::error_code ec;
+        if (_impl->socket.available(ec) > 0)
+            return true;
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        bool ready = false;
+        _impl->socket.async_wait(asio::ip::udp::socket::wait_read,
+                                 [&ready](const asio::error_code &err)
+                                 {
+                                     if (!err)
+                                         ready = true;
+                                 });
+        auto &ctx = _impl->ctx;
+        ctx.restart();
+        ctx.run_until(deadline);
+        if (!ready)
+        {
+            // Timed out: cancel the wait and let its handler complete before returning
+            _impl->socket.cancel(ec);
+            ctx.restart();
+            ctx.run();
+        }
+        return ready;
     }
 
 } // namespace engine::net
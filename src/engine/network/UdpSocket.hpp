@@ -1,9 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <optional>
+#include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -16,9 +20,49 @@ namespace engine::net
 
     class UdpSocketImpl; // hidden implementation using Asio
 
+    // Messages larger than max_datagram are sent as FRAGMENT packets and reassembled by
+    // receive(); incomplete messages are dropped after reassembly_timeout.
+    // send()/sendRaw()/send_batch() may be called from several threads at once, concurrently
+    // with one thread running receive()/receive_batch()/wait_readable(); the receive side
+    // itself is single-threaded.
     class UdpSocket
     {
     public:
+        // Conservative datagram size that avoids IP fragmentation on common paths
+        static constexpr std::size_t max_datagram = 1200;
+        static constexpr std::size_t fragment_payload =
+            max_datagram - sizeof(PacketHeader) - sizeof(FragmentHeader);
+        // Largest message payload: PacketHeader::size is 16 bits. Larger sends are refused and
+        // FRAGMENT packets announcing more are dropped before anything is allocated.
+        static constexpr std::size_t max_message = 0xFFFF;
+        static constexpr std::size_t max_fragments =
+            (max_message + fragment_payload - 1) / fragment_payload;
+        static constexpr unsigned reassembly_timeout_ms = 250;
+        // Most payload parts one gather send() takes
+        static constexpr std::size_t max_send_parts = 4;
+
+        // Datagrams moved per recvmmsg/sendmmsg call by the batched API
+        static constexpr std::size_t batch_size = 32;
+
+        using Bytes = std::span<const std::uint8_t>;
+
+        // A message returned by receive_batch(). `payload` points into the socket's receive
+        // ring and stays valid until the next receive_batch() call.
+        struct Datagram
+        {
+            PacketHeader header{};
+            Bytes payload;
+            Endpoint sender;
+        };
+
+        // A message handed to send_batch(); `to` must outlive the call
+        struct OutgoingDatagram
+        {
+            PacketHeader header{};
+            Bytes payload;
+            const Endpoint *to = nullptr;
+        };
+
         // Binds a UDP socket on the given local port (0 for ephemeral)
         UdpSocket(IoContext &ctx, unsigned short localPort);
         ~UdpSocket();
@@ -30,15 +74,45 @@ namespace engine::net
         // Send raw bytes to a remote endpoint
         void sendRaw(const void *data, std::size_t size, const Endpoint &endpoint);
 
-        // Send header + payload convenience
-        void send(const PacketHeader &header, const std::vector<std::uint8_t> &payload,
-                  const Endpoint &endpoint);
+        // Send header + payload convenience (fragmented above max_datagram)
+        void send(const PacketHeader &header, Bytes payload, const Endpoint &endpoint);
+
+        // Gather send: the header and the parts, in order, leave as one message straight from
+        // the caller's memory (scatter/gather I/O), nothing is concatenated or allocated.
+        void send(const PacketHeader &header, std::initializer_list<Bytes> parts, const Endpoint &endpoint);
+
+        // Sends a trivially copyable struct as the whole payload of a `type` packet
+        template <typename T>
+        void send(std::uint8_t type, const T &payload, const Endpoint &endpoint, std::uint32_t seq = 0)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "packets are sent as raw bytes");
+            PacketHeader header{type, static_cast<std::uint16_t>(sizeof(T)), seq};
+            send(header, Bytes(reinterpret_cast<const std::uint8_t *>(&payload), sizeof(T)), endpoint);
+        }
 
         // Non-blocking receive; returns header+payload when data is available.
-        // Fills 'sender' with the packet source.
+        // Fragments are buffered until their message is complete, which is then returned
+        // with its original type. Fills 'sender' with the packet source.
         std::optional<std::pair<PacketHeader, std::vector<std::uint8_t>>> receive(Endpoint &sender);
 
+        // Reads up to batch_size datagrams with one recvmmsg call on Linux (a receive loop
+        // elsewhere) into a ring of buffers reused from call to call. Fragments are reassembled
+        // as by receive(). Returns an empty span once the socket has nothing left.
+        std::span<const Datagram> receive_batch();
+
+        // Sends every datagram, batch_size per sendmmsg call on Linux (one send each elsewhere).
+        // Messages above max_datagram go through the fragmenting send(), in order with the rest;
+        // a datagram the kernel rejects is skipped without dropping the others.
+        void send_batch(std::span<const OutgoingDatagram> datagrams);
+
+        // Blocks on the owning IoContext until a datagram is readable or `deadline` passes.
+        // Returns true if data is ready. Lets loops sleep between ticks instead of polling.
+        bool wait_readable(std::chrono::steady_clock::time_point deadline);
+
     private:
+        void send_parts(const PacketHeader &header, const Bytes *parts, std::size_t count,
+                        const Endpoint &endpoint);
+
         std::unique_ptr<UdpSocketImpl> _impl;
     };
 
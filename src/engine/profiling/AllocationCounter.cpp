@@ -0,0 +1,83 @@
+#include "engine/profiling/AllocationCounter.hpp"
+
+#ifdef ENGINE_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace Engine {
+namespace Profiling {
+
+#ifdef ENGINE_COUNT_ALLOCATIONS
+namespace {
+thread_local uint64_t tAllocations = 0;
+
+void* countedAlloc(std::size_t size) {
+    ++tAllocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* countedAlignedAlloc(std::size_t size, std::size_t align) {
+    ++tAllocations;
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment
+    const std::size_t bytes = size ? size : 1;
+    void* p = std::aligned_alloc(align, (bytes + align - 1) / align * align);
+#endif
+    if (p)
+        return p;
+    throw std::bad_alloc();
+}
+
+void alignedFree(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+}
+
+uint64_t threadAllocationCount() {
+    return tAllocations;
+}
+#else
+uint64_t threadAllocationCount() {
+    return 0;
+}
+#endif
+
+}
+}
+
+#ifdef ENGINE_COUNT_ALLOCATIONS
+// The array and nothrow forms default to these. Sized deletes are defined as well, forwarding
+// to the same free paths (replacing only the unsized ones triggers -Wsized-deallocation).
+void* operator new(std::size_t size) {
+    return Engine::Profiling::countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return Engine::Profiling::countedAlignedAlloc(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    Engine::Profiling::alignedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    Engine::Profiling::alignedFree(p);
+}
+#endif
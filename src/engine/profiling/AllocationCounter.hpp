@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine {
+namespace Profiling {
+
+// Counting heap allocations replaces the global operator new, so it is a build option
+// (ENGINE_COUNT_ALLOCATIONS in CMake). Without it the counters below always read 0.
+constexpr bool allocationCountingEnabled() {
+#ifdef ENGINE_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Heap allocations (operator new) made by the calling thread so far
+uint64_t threadAllocationCount();
+
+// Allocations made by the calling thread since construction, e.g. around one tick
+class AllocationScope {
+public:
+    AllocationScope() : _start(threadAllocationCount()) {}
+    uint64_t count() const { return threadAllocationCount() - _start; }
+
+private:
+    uint64_t _start;
+};
+
+}
+}
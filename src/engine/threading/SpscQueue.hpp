@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+/**
+ * @file SpscQueue.hpp
+ * @brief Defines engine::spsc_queue, a bounded lock-free single-producer/single-consumer queue.
+ *
+ * One thread pushes, one thread pops; neither ever blocks or takes a lock. The producer and
+ * consumer indices live on separate cache lines so the two sides do not false-share. The
+ * consumer role may move between threads (e.g. pool workers) as long as those hand-offs are
+ * themselves synchronised.
+ *
+ * @tparam T Element type, must be default-constructible and movable.
+ */
+namespace engine
+{
+    template <typename T>
+    class spsc_queue
+    {
+    public:
+        explicit spsc_queue(std::size_t capacity = 1024)
+        {
+            std::size_t cap = 2;
+            while (cap < capacity)
+                cap <<= 1;
+            _buffer.resize(cap);
+            _mask = cap - 1;
+        }
+
+        spsc_queue(spsc_queue const &) = delete;
+        spsc_queue &operator=(spsc_queue const &) = delete;
+
+        // Producer side. Returns false (and leaves `value` untouched) when the queue is full.
+        bool try_push(T &&value)
+        {
+            std::size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) > _mask)
+                return false;
+            _buffer[tail & _mask] = std::move(value);
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Returns false when the queue is empty.
+        bool try_pop(T &out)
+        {
+            std::size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire))
+                return false;
+            out = std::move(_buffer[head & _mask]);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t capacity() const noexcept { return _mask + 1; }
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+
+        std::vector<T> _buffer;
+        std::size_t _mask = 0;
+        alignas(cache_line) std::atomic<std::size_t> _head{0}; // next slot to pop
+        alignas(cache_line) std::atomic<std::size_t> _tail{0}; // next slot to push
+    };
+
+}
@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+/**
+ * @file ThreadPool.hpp
+ * @brief Defines engine::thread_pool, a small work-stealing pool for fork/join parallelism.
+ *
+ * Each worker owns a task deque: it pops its own tasks from the back (most recent first) and,
+ * once empty, steals from the front of the other workers' deques, so uneven tasks balance out.
+ * parallel_for() spreads its iterations over the deques and the calling thread helps running
+ * them until all are done, which also makes nested parallel_for calls from a worker safe.
+ *
+ * Tasks only reference the caller's callable (no allocation per task); it must stay valid
+ * until parallel_for returns, which it does by construction. The deques are rings that only
+ * grow, so once they have held a tick's tasks parallel_for no longer touches the heap.
+ *
+ * An exception thrown by an iteration does not leave its thread: the first one is kept,
+ * the remaining iterations still run, and parallel_for rethrows it once every task is done
+ * (unwinding earlier would leave queued tasks pointing at the caller's stack).
+ */
+namespace engine
+{
+    class thread_pool
+    {
+    public:
+        // `workers` background threads; 0 runs everything on the calling thread.
+        explicit thread_pool(std::size_t workers = default_workers())
+        {
+            for (std::size_t i = 0; i < workers; ++i)
+                _queues.push_back(std::make_unique<worker_queue>());
+            for (std::size_t i = 0; i < workers; ++i)
+                _threads.emplace_back([this, i] { worker_loop(i); });
+        }
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                _stop = true;
+            }
+            _wake.notify_all();
+            for (auto &t : _threads)
+                t.join();
+        }
+
+        thread_pool(thread_pool const &) = delete;
+        thread_pool &operator=(thread_pool const &) = delete;
+
+        // One thread per core, minus the caller which helps in parallel_for
+        static std::size_t default_workers()
+        {
+            unsigned hw = std::thread::hardware_concurrency();
+            return hw > 1 ? hw - 1 : 0;
+        }
+
+        std::size_t size() const noexcept { return _threads.size(); }
+
+        /**
+         * @brief Calls f(i) for every i in [0, count) and returns once all calls completed.
+         * @throws The first exception thrown by f, after all calls completed.
+         */
+        template <typename Function>
+        void parallel_for(std::size_t count, Function &&f)
+        {
+            if (count == 0)
+                return;
+            if (_queues.empty() || count == 1)
+            {
+                std::exception_ptr error;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    try
+                    {
+                        f(i);
+                    }
+                    catch (...)
+                    {
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+                if (error)
+                    std::rethrow_exception(error);
+                return;
+            }
+
+            batch b;
+            b.remaining.store(count, std::memory_order_relaxed);
+            auto *ctx = static_cast<void *>(&f);
+            auto invoke = [](void *c, std::size_t i) { (*static_cast<std::remove_reference_t<Function> *>(c))(i); };
+            {
+                // Counted before being queued so that takers never see it go below zero
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                _pending += count;
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                worker_queue &q = *_queues[i % _queues.size()];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.tasks.push_back(task{invoke, ctx, i, &b});
+            }
+            _wake.notify_all();
+
+            // Help instead of blocking; only spin once every task has been claimed
+            while (b.remaining.load(std::memory_order_acquire) != 0)
+            {
+                task t;
+                if (try_take(current_worker(), t))
+                    run(t);
+                else
+                    std::this_thread::yield();
+            }
+            if (b.error)
+                std::rethrow_exception(b.error);
+        }
+
+    private:
+        // State shared by the tasks of one parallel_for call, on the caller's stack
+        struct batch
+        {
+            std::atomic<std::size_t> remaining{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error; // written once, by the task that set `failed`
+        };
+
+        struct task
+        {
+            void (*fn)(void *, std::size_t) = nullptr;
+            void *ctx = nullptr;
+            std::size_t index = 0;
+            batch *owner = nullptr;
+        };
+
+        // Double-ended queue of tasks on a power-of-two ring; std::deque would free and
+        // reallocate its blocks as tasks cycle through
+        class task_ring
+        {
+        public:
+            bool empty() const noexcept { return _head == _tail; }
+
+            void push_back(task const &t)
+            {
+                if (_tail - _head == _slots.size())
+                    grow();
+                _slots[_tail++ & (_slots.size() - 1)] = t;
+            }
+
+            task pop_back() { return _slots[--_tail & (_slots.size() - 1)]; }
+            task pop_front() { return _slots[_head++ & (_slots.size() - 1)]; }
+
+        private:
+            void grow()
+            {
+                std::vector<task> slots(_slots.empty() ? 16 : _slots.size() * 2);
+                for (std::size_t i = _head; i != _tail; ++i)
+                    slots[i - _head] = _slots[i & (_slots.size() - 1)];
+                _tail -= _head;
+                _head = 0;
+                _slots = std::move(slots);
+            }
+
+            std::vector<task> _slots;
+            std::size_t _head = 0; // index of the front task, unwrapped
+            std::size_t _tail = 0; // one past the back task, unwrapped
+        };
+
+        struct worker_queue
+        {
+            std::mutex mutex;
+            task_ring tasks;
+        };
+
+        static constexpr std::size_t no_worker = static_cast<std::size_t>(-1);
+
+        // Index of the pool worker running on this thread, no_worker for outside threads
+        std::size_t current_worker() const
+        {
+            return tls_pool() == this ? tls_index() : no_worker;
+        }
+
+        static thread_pool const *&tls_pool()
+        {
+            thread_local thread_pool const *pool = nullptr;
+            return pool;
+        }
+
+        static std::size_t &tls_index()
+        {
+            thread_local std::size_t index = no_worker;
+            return index;
+        }
+
+        static void run(task &t)
+        {
+            try
+            {
+                t.fn(t.ctx, t.index);
+            }
+            catch (...)
+            {
+                if (!t.owner->failed.exchange(true, std::memory_order_relaxed))
+                    t.owner->error = std::current_exception();
+            }
+            // Release publishes `error` to the caller, which acquires `remaining`
+            t.owner->remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        bool try_take(std::size_t self, task &out)
+        {
+            if (self != no_worker && pop_back(*_queues[self], out))
+                return true;
+            std::size_t n = _queues.size();
+            std::size_t start = self == no_worker ? 0 : self + 1;
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                std::size_t victim = (start + k) % n;
+                if (victim != self && steal_front(*_queues[victim], out))
+                    return true;
+            }
+            return false;
+        }
+
+        bool pop_back(worker_queue &q, task &out)
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                return false;
+            out = q.tasks.pop_back();
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool steal_front(worker_queue &q, task &out)
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                return false;
+            out = q.tasks.pop_front();
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void worker_loop(std::size_t self)
+        {
+            tls_pool() = this;
+            tls_index() = self;
+            for (;;)
+            {
+                task t;
+                if (try_take(self, t))
+                {
+                    run(t);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                _wake.wait(lock, [this] { return _stop || _pending.load(std::memory_order_relaxed) > 0; });
+                if (_stop)
+                    return;
+            }
+        }
+
+        std::vector<std::unique_ptr<worker_queue>> _queues;
+        std::vector<std::thread> _threads;
+        std::atomic<std::size_t> _pending{0};
+        std::mutex _sleepMutex;
+        std::condition_variable _wake;
+        bool _stop = false;
+    };
+
+}
@@ -64,6 +64,7 @@
 namespace component
 {
     struct ai_controller {
+        static constexpr bool packed_storage = true;
         std::string behavior;
         float speed = 2.0f;
         uint32_t shootCooldown = 0;
@@ -80,10 +81,12 @@ namespace component
     };
 
     struct spellbook {
+        static constexpr bool packed_storage = true;
         std::vector<spell> spells;
     };
 
     struct boss_phase {
+        static constexpr bool packed_storage = true;
         int hpThreshold{0};
         std::string nextAI;
     };
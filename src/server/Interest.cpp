@@ -0,0 +1,239 @@
+#include "Interest.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "common/PlayerMovement.hpp"
+#include "engine/ecs/Entity.hpp"
+
+namespace
+{
+  // Entry of `states` (sorted by id) for `id`; `cursor` only moves forward, for merge walks
+  const EntityState *find_sorted(const snapshot::States *states, std::size_t &cursor, uint32_t id)
+  {
+    if (!states)
+      return nullptr;
+    while (cursor < states->size() && (*states)[cursor].entityId < id)
+      ++cursor;
+    return (cursor < states->size() && (*states)[cursor].entityId == id) ? &(*states)[cursor] : nullptr;
+  }
+
+  // Fields the delta entry of `cur` carries against `base` (every field for a new entity)
+  uint8_t changed_fields(const EntityState *base, const EntityState &cur)
+  {
+    return base ? snapshot::diff_fields(*base, cur) : static_cast<uint8_t>(snapshot::FIELD_ALL);
+  }
+
+  std::ptrdiff_t bits(std::size_t n)
+  {
+    return static_cast<std::ptrdiff_t>(n);
+  }
+
+  // Where slot `s` would join the id list made of the slots `in` accepts: its gap from the
+  // previous id (0 before the first), and the bits the gap of the next id changes by
+  struct Join
+  {
+    uint32_t gap;
+    std::ptrdiff_t next;
+  };
+
+  template <typename Slot, typename In>
+  Join join(const std::vector<Slot> &slots, std::size_t s, In in)
+  {
+    uint32_t prev = 0;
+    for (std::size_t k = s; k-- > 0;)
+    {
+      if (in(slots[k]))
+      {
+        prev = slots[k].id;
+        break;
+      }
+    }
+    const uint32_t id = slots[s].id;
+    Join j{id - prev, 0};
+    for (std::size_t k = s + 1; k < slots.size(); ++k)
+    {
+      if (in(slots[k]))
+      {
+        j.next = bits(snapshot::id_gap_bits(slots[k].id - id)) - bits(snapshot::id_gap_bits(slots[k].id - prev));
+        break;
+      }
+    }
+    return j;
+  }
+}
+
+void ClientInterest::reserve(std::size_t entities)
+{
+  _priority.reserve(entities);
+  _candidates.reserve(entities);
+  _slots.reserve(2 * entities); // world and baseline ids
+}
+
+float ClientInterest::relevance(const EntityState &es, uint8_t changed, float shipX, float shipY)
+{
+  if (es.x < -offscreen_margin || es.x > SCREEN_WIDTH + offscreen_margin ||
+      es.y < -offscreen_margin || es.y > SCREEN_HEIGHT + offscreen_margin)
+    return 0.f;
+
+  float score;
+  switch (static_cast<component::entity_kind>(es.type))
+  {
+  case component::entity_kind::enemyProjectile:
+    score = 4.f; // threatens the ship
+    break;
+  case component::entity_kind::enemy:
+    score = 3.f;
+    break;
+  case component::entity_kind::projectile_bomb:
+  case component::entity_kind::missile_explosion:
+    score = 2.5f;
+    break;
+  case component::entity_kind::playerProjectile:
+  case component::entity_kind::projectile_charged:
+    score = 2.f;
+    break;
+  default:
+    score = 1.f;
+    break;
+  }
+  if (es.x < 0.f || es.x > SCREEN_WIDTH || es.y < 0.f || es.y > SCREEN_HEIGHT)
+    score *= 0.25f;
+  // Spawns, hits and deaths show more than a few pixels of motion
+  if (changed & (snapshot::FIELD_TYPE | snapshot::FIELD_HP | snapshot::FIELD_COLLIDED | snapshot::FIELD_HITBOX))
+    score *= 2.f;
+
+  const float diagonal = std::hypot(static_cast<float>(SCREEN_WIDTH), static_cast<float>(SCREEN_HEIGHT));
+  const float distance = std::hypot(es.x - shipX, es.y - shipY);
+  return score * (2.f - std::min(distance / diagonal, 1.f));
+}
+
+std::ptrdiff_t ClientInterest::send_cost(std::size_t s, const EntityState &state) const
+{
+  const Slot &slot = _slots[s];
+  std::ptrdiff_t cost = 0;
+  if (const uint8_t changed = changed_fields(slot.base, state))
+  {
+    const Join j = join(_slots, s, [](const Slot &o) { return o.written; });
+    cost += bits(snapshot::entry_bits(changed, j.gap)) + j.next;
+  }
+  if (slot.base)
+  {
+    // Sent, it is no longer listed as removed
+    const Join j = join(_slots, s, [](const Slot &o) { return o.base && !o.sent; });
+    cost -= bits(snapshot::id_gap_bits(j.gap)) + j.next;
+  }
+  return cost;
+}
+
+void ClientInterest::send(std::size_t s, const EntityState &state)
+{
+  Slot &slot = _slots[s];
+  slot.sent = &state;
+  slot.written = changed_fields(slot.base, state) != 0;
+}
+
+void ClientInterest::select(const snapshot::States &world, uint32_t shipId, const snapshot::States *baseline,
+                            const snapshot::States *lastSent, snapshot::States &out)
+{
+  out.clear();
+  _candidates.clear();
+  _slots.clear();
+
+  float shipX = SCREEN_WIDTH * 0.5f;
+  float shipY = SCREEN_HEIGHT * 0.5f;
+  auto ship = std::lower_bound(world.begin(), world.end(), shipId,
+                               [](const EntityState &es, uint32_t id) { return es.entityId < id; });
+  if (ship != world.end() && ship->entityId == shipId)
+  {
+    shipX = ship->x;
+    shipY = ship->y;
+  }
+
+  // Nothing sent yet: the delta is its header and every baseline id listed as removed
+  std::ptrdiff_t used = bits(sizeof(DeltaSnapshot) * 8);
+  uint32_t lastRemoved = 0;
+  auto add_slot = [&](uint32_t id, const EntityState *base)
+  {
+    _slots.push_back(Slot{id, base, nullptr, false});
+    if (base)
+    {
+      used += bits(snapshot::id_gap_bits(id - lastRemoved));
+      lastRemoved = id;
+    }
+  };
+
+  // Players and entities unchanged since the baseline are always kept: they sort first
+  constexpr float always = std::numeric_limits<float>::infinity();
+  const std::size_t baseCount = baseline ? baseline->size() : 0;
+  std::size_t b = 0;
+  std::size_t l = 0;
+  for (const EntityState &es : world)
+  {
+    while (b < baseCount && (*baseline)[b].entityId < es.entityId)
+    {
+      add_slot((*baseline)[b].entityId, &(*baseline)[b]);
+      ++b;
+    }
+    const EntityState *base = find_sorted(baseline, b, es.entityId);
+    if (base)
+      ++b;
+    const EntityState *known = find_sorted(lastSent, l, es.entityId);
+    add_slot(es.entityId, base);
+    const std::size_t slot = _slots.size() - 1;
+    const std::size_t index = static_cast<std::size_t>(engine::entity_t::from_handle(es.entityId));
+    if (index >= _priority.size())
+      _priority.resize(index + 1, 0.f);
+
+    const uint8_t changed = changed_fields(base, es);
+    if (es.type == static_cast<uint8_t>(component::entity_kind::player))
+    {
+      _candidates.push_back(Candidate{slot, index, always, &es, known});
+      continue;
+    }
+    const float score = relevance(es, changed, shipX, shipY);
+    if (score <= 0.f || changed == 0)
+    {
+      // Irrelevant: dropped. Unchanged since the baseline: kept, it only saves bytes.
+      _priority[index] = 0.f;
+      if (score > 0.f)
+        _candidates.push_back(Candidate{slot, index, always, &es, known});
+      continue;
+    }
+    _priority[index] += score;
+    _candidates.push_back(Candidate{slot, index, _priority[index], &es, known});
+  }
+  for (; b < baseCount; ++b)
+    add_slot((*baseline)[b].entityId, &(*baseline)[b]);
+
+  std::sort(_candidates.begin(), _candidates.end(),
+            [](const Candidate &a, const Candidate &c) { return a.priority > c.priority; });
+  const std::ptrdiff_t budget = bits(packet_budget * 8);
+  for (const Candidate &c : _candidates)
+  {
+    const std::ptrdiff_t cost = send_cost(c.slot, *c.state);
+    if (c.priority == always || used + cost <= budget)
+    {
+      send(c.slot, *c.state);
+      _priority[c.index] = 0.f;
+      used += cost;
+    }
+    else if (c.known)
+    {
+      // The stale entry is not free either (the baseline may predate it): without room
+      // for it the entity is dropped and comes back in full later
+      const std::ptrdiff_t stale = send_cost(c.slot, *c.known);
+      if (used + stale <= budget)
+      {
+        send(c.slot, *c.known);
+        used += stale;
+      }
+    }
+  }
+
+  // Slot order keeps the result sorted by id
+  for (const Slot &slot : _slots)
+  {
+    if (slot.sent)
+      out.push_back(*slot.sent);
+  }
+}
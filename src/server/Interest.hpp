@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "common/Packets.hpp"
+#include "common/SnapshotDelta.hpp"
+#include "engine/network/UdpSocket.hpp"
+/**
+ * @class ClientInterest
+ * @brief Chooses the entities one client's snapshot carries, by relevance and within a byte budget.
+ *
+ * The room builds one world state per tick; each client gets the part of it worth sending:
+ * - Players are always sent.
+ * - Entities beyond offscreen_margin of the screen are not relevant and are dropped (the
+ *   delta removes them client-side; they come back in full when they get closer).
+ * - Entities the client already has unchanged cost nothing and are always kept.
+ * - The remaining changed entities compete for packet_budget bytes. A pick is charged what
+ *   it adds to the encoded delta: its entry with the actual id gaps around it, minus the
+ *   removed id it no longer needs when the client's baseline has it. Each tick adds their
+ *   relevance score (kind, on screen, distance to the client's ship, kind of change) to an
+ *   accumulated priority; the highest priorities are sent and reset to zero. An entity that
+ *   loses keeps accumulating, so it is sent after a few ticks even if it never scores high.
+ * - A known entity that does not fit keeps the state the client was last sent instead of
+ *   being removed, as long as that stale entry fits the budget: it pauses on screen rather
+ *   than blinking out.
+ *
+ * One instance per client: the accumulated priorities are that client's.
+ */
+class ClientInterest
+{
+public:
+    // Delta payload per client snapshot: what one datagram holds after its PacketHeader, so
+    // snapshots are never fragmented (players, always sent, are the only exception)
+    static constexpr std::size_t packet_budget = engine::net::UdpSocket::max_datagram - sizeof(PacketHeader);
+    // Distance outside the screen within which entities are still sent (about to appear)
+    static constexpr float offscreen_margin = 400.f;
+
+    /**
+     * @brief Fills `out` (cleared first, sorted by id) with the states this client gets.
+     * @param world Every entity state of this tick, sorted by entityId.
+     * @param shipId Handle of the client's ship, whose position anchors distances.
+     * @param baseline Snapshot the client acknowledged (delta base), or nullptr.
+     * @param lastSent Snapshot last sent to the client, or nullptr.
+     */
+    void select(const snapshot::States &world, uint32_t shipId, const snapshot::States *baseline,
+                const snapshot::States *lastSent, snapshot::States &out);
+
+    // Makes room for `entities` world states on entity indices below it
+    void reserve(std::size_t entities);
+
+    // Priority gained per tick by an entity; 0 when it is not relevant to this client
+    static float relevance(const EntityState &es, uint8_t changed, float shipX, float shipY);
+
+private:
+    // An id of the world or of the baseline, in id order as write_delta() lists them
+    struct Slot
+    {
+        uint32_t id;
+        const EntityState *base; // state in the baseline, if any
+        const EntityState *sent; // state the client gets, nullptr if none
+        bool written;            // sent with a non-empty delta entry
+    };
+
+    struct Candidate
+    {
+        std::size_t slot;
+        std::size_t index; // entity index, into _priority
+        float priority;
+        const EntityState *state; // current state
+        const EntityState *known; // state last sent to the client, if any
+    };
+
+    // Bits the encoded delta grows by (negative when it shrinks) if slot `s` gets `state`
+    std::ptrdiff_t send_cost(std::size_t s, const EntityState &state) const;
+    void send(std::size_t s, const EntityState &state);
+
+    std::vector<float> _priority; // accumulated priority, by entity index
+    std::vector<Candidate> _candidates;
+    std::vector<Slot> _slots;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "engine/ecs/Registry.hpp"
+#include "engine/ecs/Components.hpp"
+/**
+ * @class LagHistory
+ * @brief Enemy hitboxes of the last few ticks, for resolving player shots against what the shooter saw.
+ *
+ * A client draws enemies a round trip plus its interpolation delay in the past, so a shot
+ * aimed at an enemy on screen misses the enemy's current server position. The room records
+ * where every enemy was at the end of each tick (the state its snapshot sent) and tests the
+ * projectiles of a player against the enemies as of that player's view tick instead.
+ *
+ * Frames live in a ring of depth() ticks whose entry vectors are reused, so recording stops
+ * allocating once the ring has seen the largest enemy count (or below the reserve()d one).
+ */
+class LagHistory
+{
+public:
+    struct Entry
+    {
+        uint32_t handle; // generational: an enemy that died since no longer resolves
+        component::position pos;
+        component::hitbox hitbox;
+    };
+
+    explicit LagHistory(std::size_t depth) : _frames(std::max<std::size_t>(depth, 1)) {}
+
+    // Ticks a frame stays available, hence the largest usable rewind
+    std::size_t depth() const { return _frames.size(); }
+
+    // Makes room for `enemies` entries in every frame
+    void reserve(std::size_t enemies)
+    {
+        for (Frame &frame : _frames)
+            frame.entries.reserve(enemies);
+    }
+
+    // Stores the enemies of `reg` as the frame of `tick`, replacing the frame depth() ticks older
+    void record(uint32_t tick, engine::registry &reg)
+    {
+        Frame &frame = _frames[tick % _frames.size()];
+        frame.tick = tick;
+        frame.valid = true;
+        frame.entries.clear();
+        auto &hitboxes = reg.get_components<component::hitbox>();
+        reg.for_each_chunk<const component::position, const component::entity_kind>(
+            [&](std::size_t count, std::size_t const *entities, component::position const *pos,
+                component::entity_kind const *kinds) {
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                std::size_t idx = entities[k];
+                if (kinds[k] != component::entity_kind::enemy || idx >= hitboxes.size() || !hitboxes[idx])
+                  continue;
+                frame.entries.push_back(Entry{reg.entity_from_index(idx).handle(), pos[k], *hitboxes[idx]});
+              }
+            });
+    }
+
+    // Enemies as of `tick`, or nullptr when that tick is not (or no longer) recorded
+    const std::vector<Entry> *at(uint32_t tick) const
+    {
+        const Frame &frame = _frames[tick % _frames.size()];
+        return (frame.valid && frame.tick == tick) ? &frame.entries : nullptr;
+    }
+
+    void clear()
+    {
+        for (Frame &frame : _frames)
+        {
+            frame.valid = false;
+            frame.entries.clear();
+        }
+    }
+
+private:
+    struct Frame
+    {
+        uint32_t tick = 0;
+        bool valid = false;
+        std::vector<Entry> entries;
+    };
+
+    std::vector<Frame> _frames;
+};
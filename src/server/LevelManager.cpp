@@ -1,5 +1,5 @@
 #include "LevelManager.hpp"
-#include "Server.hpp"
+#include "Room.hpp"
 #include "EnemyConfig.hpp"
 #include "common/Packets.hpp"
 #include "ServerUtils.hpp"
@@ -9,7 +9,7 @@ using json = nlohmann::json;
 
 LevelManager::LevelManager(engine::registry &registry, engine::net::UdpSocket &socket,
                            std::vector<PlayerInfo> &players, uint32_t &tick,
-                           std::unordered_set<uint32_t> &liveEntities)
+                           engine::entity_set &liveEntities)
     : _registry(registry), _socket(socket), _players(players), _tick(tick),
       _liveEntities(liveEntities)
 {
@@ -56,7 +56,7 @@ void LevelManager::spawnEntities(const json &levelJson)
             EnemyConfig cfg = EnemyConfig::load_enemy_config(cfgPath);
 
             auto e = _registry.spawn_entity();
-            _liveEntities.insert(static_cast<uint32_t>(e));
+            _liveEntities.insert(static_cast<std::size_t>(e));
 
             _registry.add_component(e, component::position{x, y});
             _registry.add_component(e, component::velocity{velX, velY});
@@ -98,16 +98,14 @@ void LevelManager::update()
 
 void LevelManager::notifyLevelStart(uint32_t level)
 {
-    PacketHeader hdr{LEVEL_START, sizeof(LevelStartPayload), 0};
     LevelStartPayload p{level};
     for (auto &pl : _players)
-        _socket.send(hdr, std::vector<uint8_t>((uint8_t *)&p, (uint8_t *)&p + sizeof(p)), pl.endpoint);
+        _socket.send(LEVEL_START, p, pl.endpoint);
 }
 
 void LevelManager::notifyLevelEnd(uint32_t level)
 {
-    PacketHeader hdr{LEVEL_END, sizeof(LevelEndPayload), 0};
     LevelEndPayload p{level};
     for (auto &pl : _players)
-        _socket.send(hdr, std::vector<uint8_t>((uint8_t *)&p, (uint8_t *)&p + sizeof(p)), pl.endpoint);
+        _socket.send(LEVEL_END, p, pl.endpoint);
 }
@@ -4,19 +4,19 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <unordered_set>
 #include <nlohmann/json.hpp>
 
-class server;    
+class room;
 struct PlayerInfo;
 class LevelManager {
 public:
     LevelManager(engine::registry &registry, engine::net::UdpSocket &socket,
                  std::vector<PlayerInfo> &players, uint32_t &tick,
-                 std::unordered_set<uint32_t> &liveEntities);
+                 engine::entity_set &liveEntities);
 
     void update();
     void startNextLevel();
+    uint32_t levelStartTick() const { return _levelStartTick; }
     bool _noMoreLevels = false;
 private:
     void loadLevelFile(size_t index, nlohmann::json &out);
@@ -28,7 +28,7 @@ private:
     engine::net::UdpSocket &_socket;
     std::vector<PlayerInfo> &_players;
     uint32_t &_tick;
-    std::unordered_set<uint32_t> &_liveEntities;
+    engine::entity_set &_liveEntities;
 
     uint32_t _levelStartTick = 0;
     uint32_t _currentLevel = 1;
@@ -3,12 +3,15 @@
  * @brief Entry point for the R-Type server.
  *
  * Usage:
- *   ./r-type_server [PORT]
+ *   ./r-type_server [PORT] [TICK_RATE] [CATCH_UP] [MAX_CATCH_UP]
  *
  * Example:
- *   ./r-type_server 4242
+ *   ./r-type_server 4242 60 burst 5
  *
- * The server binds to the given port and prints the host's IP address.
+ * The server binds to the given port, simulates TICK_RATE ticks per second (default 60)
+ * and prints the host's IP address. CATCH_UP is what happens to ticks missed after a stall:
+ * "burst" (default) runs up to MAX_CATCH_UP of them back to back (default 5), "skip" runs
+ * a single one and lets the simulation fall behind.
  */
 
 #include "server/Server.hpp"
@@ -31,13 +34,54 @@ int main(int argc, char* argv[])
             port = 4242;
         }
     }
+    uint32_t tickRate = 60;
+    if (argc >= 3)
+    {
+        try {
+            tickRate = static_cast<uint32_t>(std::stoul(argv[2]));
+        } catch (...) {
+            std::cerr << "Invalid tick rate argument. Using default 60.\n";
+        }
+        if (tickRate == 0 || tickRate > 1000) {
+            std::cerr << "Tick rate must be in [1, 1000]. Using default 60.\n";
+            tickRate = 60;
+        }
+    }
+    TickScheduler::CatchUp catchUp = TickScheduler::CatchUp::Burst;
+    if (argc >= 4)
+    {
+        if (std::strcmp(argv[3], "skip") == 0)
+            catchUp = TickScheduler::CatchUp::Skip;
+        else if (std::strcmp(argv[3], "burst") != 0)
+            std::cerr << "Invalid catch-up policy (burst or skip). Using burst.\n";
+    }
+    uint32_t maxCatchUp = TickScheduler::default_max_catch_up;
+    if (argc >= 5)
+    {
+        try {
+            maxCatchUp = static_cast<uint32_t>(std::stoul(argv[4]));
+        } catch (...) {
+            std::cerr << "Invalid max catch-up argument. Using default "
+                      << TickScheduler::default_max_catch_up << ".\n";
+        }
+        if (maxCatchUp == 0) {
+            std::cerr << "Max catch-up must be at least 1. Using default "
+                      << TickScheduler::default_max_catch_up << ".\n";
+            maxCatchUp = TickScheduler::default_max_catch_up;
+        }
+    }
     try
     {
         engine::net::IoContext io;
-        server s(io, port);
+        server s(io, port, tickRate, catchUp, maxCatchUp);
 
         std::cout << "Server Address: localhost (127.0.0.1)\n";
         std::cout << "Port: " << port << "\n";
+        std::cout << "Tick rate: " << tickRate << " Hz\n";
+        if (catchUp == TickScheduler::CatchUp::Burst)
+            std::cout << "Catch-up: burst (at most " << maxCatchUp << " ticks)\n";
+        else
+            std::cout << "Catch-up: skip\n";
         std::cout << "[Profiling] Server profiling enabled. Stats will be logged periodically.\n";
         
         s.run();
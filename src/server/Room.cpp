@@ -0,0 +1,880 @@
+/**
+ * @file Room.cpp
+ * @brief Implementation of one R-Type match (room) hosted by the server.
+ *
+ * This file contains the per-match logic, including entity management, input handling,
+ * game tick handling, system registration, and enemy spawning. Each room uses its own ECS
+ * (Entity Component System) registry and sends to its players through the UDP socket shared
+ * by the lobby.
+ *
+ * Main functionalities:
+ * - Registers and manages game components and systems.
+ * - Spawns player entities for the players the lobby assigns to the room.
+ * - Processes network inputs from clients to update player states.
+ * - Spawns enemies and projectiles at regular intervals based on game ticks.
+ * - Runs game logic and updates entity states each tick.
+ * - Broadcasts game state snapshots to all players of the room.
+ *
+ * Key classes and functions:
+ * - room::room: Constructor, registers components/systems and loads the first level.
+ * - room::enqueue / room::drain_inbox: Hand-off of received packets from the network thread.
+ * - room::tick: One game tick: applies queued packets, updates game state and broadcasts a snapshot.
+ * - room::register_components: Registers all ECS components used in the game.
+ * - room::setup_systems: Registers all ECS systems, including AI and collision handling.
+ * - room::game_handler: Spawns enemies and handles game-specific logic per tick.
+ * - room::broadcast_snapshot: Sends the current game state to all players.
+ * - room::add_player: Spawns a player entity for a new endpoint and acknowledges it.
+ * - room::handle_packet: Handles a packet sent by one of the room's players.
+ * - room::spawn_player: Spawns a new player entity with default components.
+ * - room::spawn_projectile: Spawns a projectile entity for a given owner.
+ *
+ */
+#include "engine/ecs/Systems.hpp"
+#include "engine/ecs/EntityFactory.hpp"
+#include "engine/profiling/AllocationCounter.hpp"
+#include "server/ServerUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <span>
+#include <thread>
+
+#include "common/Components_client.hpp"
+#include "engine/ecs/Systems.hpp"
+#include "server/Components_ai.hpp"
+#include "server/EnemyConfig.hpp"
+#include "common/Accessibility.hpp"
+#include "server/System_ai.hpp"
+#include "Room.hpp"
+
+using json = nlohmann::json;
+
+using namespace serverutils;
+
+room::room(engine::net::UdpSocket &socket, uint32_t id, uint32_t tickRate, engine::thread_pool *pool)
+    : _socket(socket), _id(id), _tickRate(tickRate), _lagHistory(max_rewind_ms * tickRate / 1000)
+{
+  _registry.set_thread_pool(pool);
+  register_components();
+  _registry.reserve(entity_budget);
+  _broadphase.reserve(entity_budget);
+  _lagHistory.reserve(entity_budget);
+  _worldStates.reserve(entity_budget);
+  _levelManager = std::make_unique<LevelManager>(_registry, _socket, _players, _tick, _live_entities);
+}
+
+// Default components
+void room::register_components()
+{
+  _registry.register_component<component::position>();
+  _registry.register_component<component::velocity>();
+  _registry.register_component<component::hitbox>();
+  _registry.register_component<component::controllable>();
+  _registry.register_component<component::collision_state>();
+  _registry.register_component<component::health>();
+  _registry.register_component<component::damage>();
+  _registry.register_component<component::spawn_request>();
+  _registry.register_component<component::entity_kind>();
+  _registry.register_component<component::controlled_by>();
+  _registry.register_component<component::damage_cooldown>();
+  _registry.register_component<component::projectile_tag>();
+  // New modular components
+  _registry.register_component<component::gravity>();
+  _registry.register_component<component::area_effect>();
+
+  _registry.add_system<>(
+      [this](auto &reg)
+      {
+        systems::enemy_ai_system(reg, _tick);
+        // AI projectiles are reported through a per-thread list: claim them right away, a
+        // later parallel stage may let this thread help with another room's tick
+        for (auto e : systems::spawned_projectiles)
+          _live_entities.insert(static_cast<std::size_t>(e));
+        systems::spawned_projectiles.clear();
+      });
+  _registry.register_component<component::ai_controller>();
+  _registry.register_component<component::spell>();
+  _registry.register_component<component::spellbook>();
+  _registry.register_component<component::boss_phase>();
+
+  setup_systems();
+}
+
+bool room::enqueue(InboundPacket &&packet)
+{
+  return _inbox.try_push(std::move(packet));
+}
+
+void room::drain_inbox()
+{
+  while (_inbox.try_pop(_pending))
+    handle_packet(_pending.header, _pending.bytes(), _pending.sender);
+}
+
+// Runs on a pool worker: no profiler scopes here, the profiler is main-thread only
+void room::tick()
+{
+  Engine::Profiling::AllocationScope allocations;
+  _frameArena.reset();
+  drain_inbox();
+  game_handler();
+
+  float dt = 1.0f / static_cast<float>(_tickRate);
+  position_system(_registry, dt * game_speed_factor());
+  _registry.run_systems();
+
+  _lagHistory.record(_tick, _registry);
+  broadcast_snapshot();
+
+  check_game_over();
+  _tick++;
+  _tickAllocations = allocations.count();
+  if constexpr (Engine::Profiling::allocationCountingEnabled())
+  {
+    if (_tickAllocations != 0 && _running && warmed_up())
+      std::cerr << "[Profiling] ERROR: room " << _id << " tick " << _tick << " made " << _tickAllocations
+                << " heap allocations after warm-up\n";
+  }
+}
+
+// With a pool, non-conflicting parallel systems registered next to each other share a stage:
+// gravity (projectile_tag, velocity) and area effects (area_effect, damage) run together.
+// Gravity only feeds the next tick's position_system, so running it last changes nothing.
+void room::setup_systems()
+{
+  register_health_and_spawn_systems();
+  register_projectile_movement_system();
+  register_collision_system();
+  register_bounds_system();
+  register_gravity_system();
+  register_area_effect_system();
+}
+
+void room::register_health_and_spawn_systems()
+{
+  _registry.add_system<component::health, component::damage>(health_system);
+  _registry.add_system<component::spawn_request>(spawn_system);
+}
+
+void room::register_projectile_movement_system()
+{
+  _registry.add_parallel_system<component::position, component::projectile_tag>(
+      [this](engine::registry &reg, auto &, auto &) {
+        reg.for_each_chunk<component::position, component::projectile_tag>(
+            [&](std::size_t count, std::size_t const *entities, component::position *pos,
+                component::projectile_tag *proj) {
+              // Gather the direction/speed fields into flat columns for the SIMD kernel
+              std::array<float, engine::archetype_table::chunk_capacity> dirX, dirY, speed;
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                dirX[k] = proj[k].dirX;
+                dirY[k] = proj[k].dirY;
+                speed[k] = proj[k].speed;
+              }
+              engine::simd::add_scaled_pairs(&pos->x, dirX.data(), dirY.data(), speed.data(), count);
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                if (proj[k].lifetime > 0)
+                  --proj[k].lifetime;
+                if (proj[k].lifetime <= 0)
+                  despawn(reg.entity_from_index(entities[k]));
+              }
+            });
+      });
+}
+
+void room::register_gravity_system()
+{
+  _registry.add_parallel_system<component::projectile_tag, const component::gravity, component::velocity>(
+      [](engine::registry &reg, auto &, auto const &, auto &) {
+        reg.for_each_chunk<component::projectile_tag, const component::gravity, component::velocity>(
+            [](std::size_t count, std::size_t const *, component::projectile_tag *proj,
+               component::gravity const *grav, component::velocity *vel) {
+              std::array<float, engine::archetype_table::chunk_capacity> dirX, dirY, speed, ay;
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                dirX[k] = proj[k].dirX;
+                dirY[k] = proj[k].dirY;
+                speed[k] = proj[k].speed;
+                ay[k] = grav[k].ay;
+              }
+              engine::simd::add(dirY.data(), ay.data(), count);
+              engine::simd::scale_pairs(&vel->vx, dirX.data(), dirY.data(), speed.data(), count);
+              for (std::size_t k = 0; k < count; ++k)
+                proj[k].dirY = dirY[k];
+            });
+      });
+}
+
+void room::register_collision_system()
+{
+  // Only the pairs handled below reach the narrow phase (no projectile vs projectile, enemy vs enemy...)
+  using component::entity_kind;
+  _collisionMatrix.allow(entity_kind::player, entity_kind::enemy)
+      .allow(entity_kind::playerProjectile, entity_kind::enemy)
+      .allow(entity_kind::projectile_charged, entity_kind::enemy)
+      .allow(entity_kind::projectile_bomb, entity_kind::enemy)
+      .allow(entity_kind::enemyProjectile, entity_kind::player)
+      .allow(entity_kind::projectile_bomb, entity_kind::player);
+
+  _registry.add_system<component::position, component::hitbox>(
+      [this](engine::registry &reg,
+             engine::storage_t<component::position> &positions,
+             engine::sparse_array<component::hitbox> &hitboxes) {
+        auto &collisions = _registry.get_components<component::collision_state>();
+        auto &velocities = _registry.get_components<component::velocity>();
+        auto &kinds = _registry.get_components<component::entity_kind>();
+        auto &damages = _registry.get_components<component::damage>();
+        auto &cooldowns = _registry.get_components<component::damage_cooldown>();
+        auto &projectiles = _registry.get_components<component::projectile_tag>();
+        bool *newCollided = _frameArena.create_array<bool>(collisions.size());
+        // Kills are deferred to the end of the system: a projectile that already hit something
+        // is still present for the remaining pairs and must be skipped by hand.
+        bool *spent = _frameArena.create_array<bool>(hitboxes.size());
+        auto consume = [&](std::size_t idx) {
+          spent[idx] = true;
+          despawn(reg.entity_from_index(idx));
+        };
+        auto add_damage = [&](std::size_t idx, int amount) {
+          reg.commands().patch<component::damage>(reg.entity_from_index(idx),
+                                                   [amount](component::damage &d) { d.amount += amount; });
+        };
+        // projectile_tag::owner is a generational handle: a dead owner (even if its index
+        // was recycled since) resolves to unknown instead of whatever lives there now.
+        auto owner_kind = [&](component::projectile_tag const &proj) {
+          auto owner = engine::entity_t::from_handle(proj.owner);
+          if (!reg.is_alive(owner) || owner >= kinds.size() || !kinds[owner])
+            return component::entity_kind::unknown;
+          return kinds[owner].value();
+        };
+
+        auto is_player_shot = [](component::entity_kind kind) {
+          return kind == component::entity_kind::playerProjectile || kind == component::entity_kind::projectile_charged ||
+                 kind == component::entity_kind::projectile_bomb;
+        };
+        auto shot_hits_enemy = [&](std::size_t p, component::entity_kind kind, std::size_t enemy) {
+          if (p >= projectiles.size() || !projectiles[p])
+            return;
+          auto &proj = projectiles[p].value();
+          if (owner_kind(proj) == component::entity_kind::enemy)
+            return;
+          add_damage(enemy, proj.damage);
+          if (kind == component::entity_kind::projectile_bomb && p < positions.size() && positions[p])
+          {
+            auto pPos = positions[p].value();
+            int damage = proj.damage;
+            reg.commands().defer([this, pPos, damage](engine::registry &) {
+              auto exp = spawn_missile_explosion(pPos.x, pPos.y, damage, 180.f);
+              _live_entities.insert(static_cast<std::size_t>(exp));
+            });
+          }
+          consume(p);
+        };
+        // Enemies as the shooter of projectile p saw them, nullptr to use their current positions
+        auto rewound_enemies = [&](std::size_t p) -> std::vector<LagHistory::Entry> const * {
+          if (p >= projectiles.size() || !projectiles[p])
+            return nullptr;
+          uint32_t rewind = projectiles[p]->rewindTicks;
+          if (rewind == 0 || rewind > _tick)
+            return nullptr;
+          return _lagHistory.at(_tick - rewind);
+        };
+
+        hitbox_system(reg, positions, hitboxes, kinds, _collisionMatrix, _broadphase, [&](std::size_t i, std::size_t j) {
+          if (spent[i] || spent[j])
+            return;
+          auto kindI = (i < kinds.size() && kinds[i]) ? kinds[i].value() : component::entity_kind::unknown;
+          auto kindJ = (j < kinds.size() && kinds[j]) ? kinds[j].value() : component::entity_kind::unknown;
+
+          if (kindI == component::entity_kind::player && kindJ == component::entity_kind::enemy)
+          {
+            apply_damage_with_cooldown(i, _tick, reg, damages, cooldowns, collisions);
+            newCollided[i] = true;
+            resolve_block(i, j, positions, hitboxes, collisions, velocities);
+          }
+          if (kindJ == component::entity_kind::player && kindI == component::entity_kind::enemy)
+          {
+            apply_damage_with_cooldown(j, _tick, reg, damages, cooldowns, collisions);
+            newCollided[j] = true;
+            resolve_block(j, i, positions, hitboxes, collisions, velocities);
+          }
+
+          // Lag-compensated shots are tested against past enemy positions below instead
+          if (is_player_shot(kindI) && kindJ == component::entity_kind::enemy && !rewound_enemies(i))
+            shot_hits_enemy(i, kindI, j);
+          if (is_player_shot(kindJ) && kindI == component::entity_kind::enemy && !rewound_enemies(j))
+            shot_hits_enemy(j, kindJ, i);
+
+          if ((kindI == component::entity_kind::enemyProjectile || kindI == component::entity_kind::projectile_bomb) && kindJ == component::entity_kind::player)
+          {
+            if (i < projectiles.size() && projectiles[i])
+            {
+              auto &proj = projectiles[i].value();
+              auto ownerKind = owner_kind(proj);
+              if (ownerKind != component::entity_kind::player)
+              {
+                add_damage(j, proj.damage);
+                consume(i);
+              }
+            }
+          }
+
+          if ((kindJ == component::entity_kind::enemyProjectile || kindJ == component::entity_kind::projectile_bomb) && kindI == component::entity_kind::player)
+          {
+            if (j < projectiles.size() && projectiles[j])
+            {
+              auto &proj = projectiles[j].value();
+              auto ownerKind = owner_kind(proj);
+              if (ownerKind != component::entity_kind::player)
+              {
+                add_damage(i, proj.damage);
+                consume(j);
+              }
+            }
+          }
+        });
+
+        // Lag-compensated shots: first enemy (still alive) that overlapped them at the shooter's view tick
+        reg.for_each_chunk<const component::position, const component::entity_kind>(
+            [&](std::size_t count, std::size_t const *entities, component::position const *pos,
+                component::entity_kind const *kindsChunk) {
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                std::size_t p = entities[k];
+                if (!is_player_shot(kindsChunk[k]) || p >= hitboxes.size() || !hitboxes[p] || spent[p])
+                  continue;
+                auto const *enemies = rewound_enemies(p);
+                if (!enemies)
+                  continue;
+                for (auto const &enemy : *enemies)
+                {
+                  auto target = engine::entity_t::from_handle(enemy.handle);
+                  if (reg.is_alive(target) &&
+                      engine::detail::hitboxes_overlap(pos[k], *hitboxes[p], enemy.pos, enemy.hitbox))
+                  {
+                    shot_hits_enemy(p, kindsChunk[k], target);
+                    break;
+                  }
+                }
+              }
+            });
+
+        for (std::size_t idx = 0; idx < collisions.size(); ++idx)
+        {
+          if (collisions[idx]) collisions[idx]->collided = newCollided[idx];
+        }
+      });
+}
+
+void room::register_bounds_system()
+{
+  _registry.add_parallel_system<component::position, component::velocity, const component::entity_kind>(
+      [this](engine::registry &reg, auto &, auto &, auto const &) {
+        // Archetype chunks: every row has all three components, no per-index presence checks
+        reg.for_each_chunk<component::position, component::velocity, const component::entity_kind>(
+            [&](std::size_t count, std::size_t const *entities, component::position *pos,
+                component::velocity *vel, component::entity_kind const *kinds) {
+              for (std::size_t k = 0; k < count; ++k)
+              {
+                auto kind = kinds[k];
+                float x = pos[k].x;
+                float y = pos[k].y;
+
+                if (kind == component::entity_kind::playerProjectile || kind == component::entity_kind::enemyProjectile)
+                {
+                  if (x < -50.f || x > SCREEN_WIDTH + 50.f || y < -50.f || y > SCREEN_HEIGHT + 50.f)
+                    despawn(reg.entity_from_index(entities[k]));
+                  continue;
+                }
+
+                bool corrected = false;
+                if (kind == component::entity_kind::player)
+                {
+                  // The clamp client prediction applies too: both sides must agree on it
+                  corrected = clamp_player_position(pos[k]);
+                  x = pos[k].x;
+                  y = pos[k].y;
+                }
+                else
+                {
+                  if (x < -90.f && kind == component::entity_kind::enemy) {
+                    x = SCREEN_WIDTH + 100;
+                    corrected = true;
+                  }
+                  else if (x < 0.f && kind != component::entity_kind::enemy) { x = 0.f; corrected = true; }
+                  else if (x > SCREEN_WIDTH) { x = SCREEN_WIDTH; corrected = true; }
+                  if (y < 0.f) { y = 0.f; corrected = true; }
+                  else if (y > SCREEN_HEIGHT) { y = SCREEN_HEIGHT; corrected = true; }
+                }
+                if (corrected)
+                {
+                  pos[k].x = x;
+                  pos[k].y = y;
+                  vel[k].vx = (x <= 0.f || x >= SCREEN_WIDTH) ? 0.f : vel[k].vx;
+                  vel[k].vy = (y <= 0.f || y >= SCREEN_HEIGHT) ? 0.f : vel[k].vy;
+                }
+              }
+            });
+      });
+}
+
+void room::register_area_effect_system()
+{
+  _registry.add_parallel_system<const component::position, component::area_effect,
+                                const component::entity_kind, component::damage>(
+      // damage stays declared as written: the patches below land on it when the stage ends
+      [](engine::registry &reg,
+         engine::storage_t<component::position> const &positions,
+         engine::sparse_set<component::area_effect> &areas,
+         engine::storage_t<component::entity_kind> const &kinds,
+         engine::sparse_array<component::damage> &) {
+        for (auto &&[i, pos, area, kind] : indexed_zipper(positions, areas, kinds))
+        {
+          (void)i;
+          if (kind != component::entity_kind::missile_explosion) continue;
+          if (area.applied) continue;
+          for (size_t j = 0; j < kinds.size(); ++j)
+          {
+            if (j >= positions.size() || !kinds[j] || !positions[j]) continue;
+            if (kinds[j].value() != component::entity_kind::enemy) continue;
+            float centerX = pos.x + (area.radius);
+            float centerY = pos.y + (area.radius);
+            auto ep = positions[j].value();
+            float dx = ep.x - centerX;
+            float dy = ep.y - centerY;
+            if ((dx * dx + dy * dy) <= area.radius * area.radius)
+            {
+              const int amount = area.damage;
+              reg.commands().patch<component::damage>(reg.entity_from_index(j),
+                                                       [amount](component::damage &d) { d.amount += amount; });
+            }
+          }
+          area.applied = true;
+        }
+      });
+}
+
+void room::game_handler()
+{
+  for (auto &p : _players)
+  {
+    _live_entities.insert(static_cast<std::size_t>(p.entityId));
+  }
+  _levelManager->update();
+
+  if (_levelManager->_noMoreLevels)
+  {
+    auto &healths = _registry.get_components<component::health>();
+    auto &kinds   = _registry.get_components<component::entity_kind>();
+    std::vector<uint32_t> alivePlayers;
+
+    for (auto &&[i, kind] : indexed_zipper(kinds))
+    {
+        if (kind == component::entity_kind::player)
+        {
+            if (i < healths.size() && healths[i] && healths[i]->hp > 0)
+                alivePlayers.push_back(_registry.entity_from_index(i).handle());
+        }
+    }
+    uint32_t winnerId = alivePlayers.empty() ? UINT32_MAX : alivePlayers[0];
+    broadcast_game_over(winnerId);
+    _running = false;
+    return;
+  }
+}
+
+void room::broadcast_snapshot()
+{
+  auto &positions = _registry.get_components<component::position>();
+  auto &kinds = _registry.get_components<component::entity_kind>();
+  auto &collisions = _registry.get_components<component::collision_state>();
+  auto &healths = _registry.get_components<component::health>();
+  auto &velocities = _registry.get_components<component::velocity>();
+
+  constexpr std::size_t SNAPSHOT_LIMIT = 10000;
+  snapshot::States &states = _worldStates;
+  states.clear();
+  std::span<bool> inserted(_frameArena.create_array<bool>(positions.size()), positions.size());
+
+  auto &hitboxes = _registry.get_components<component::hitbox>();
+  SnapshotBuilderContext ctx{positions, velocities, kinds, collisions, healths, hitboxes, _registry};
+  for (auto &pInfo : _players)
+  {
+    try_add_entity(static_cast<uint32_t>(pInfo.entityId), states, ctx, inserted,
+                   SNAPSHOT_LIMIT);
+  }
+  _live_entities.for_each([&](std::size_t index)
+                          { try_add_entity(static_cast<uint32_t>(index), states, ctx, inserted, SNAPSHOT_LIMIT); });
+  if (states.empty())
+    return;
+
+  // Delta encoding and interest selection walk states together by id
+  std::sort(states.begin(), states.end(),
+            [](const EntityState &a, const EntityState &b) { return a.entityId < b.entityId; });
+  const uint32_t sequence = _snapshotSequence++;
+  if (_deltaBuffers.size() < _players.size())
+    _deltaBuffers.resize(_players.size());
+  _outgoing.clear();
+  _snapshotSentAt[sequence % snapshot::History::CAPACITY] = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < _players.size(); ++i)
+  {
+    PlayerInfo &p = _players[i];
+    snapshot::StatesPtr baseline = p.sentSnapshots.find(p.ackSequence);
+    snapshot::StatesPtr lastSent = p.sentSnapshots.find(sequence - 1);
+    auto current = acquire_snapshot_states();
+    p.interest.select(states, p.entityId.handle(), baseline.get(), lastSent.get(), *current);
+    DeltaSnapshot snap{_tick, sequence, p.ackSequence, p.inputTick, 0, 0};
+    snapshot::write_delta(snap, *current, baseline.get(), _deltaBuffers[i]);
+    PacketHeader hdr{SNAPSHOT_DELTA, static_cast<uint16_t>(_deltaBuffers[i].size()), _tick};
+    _outgoing.push_back({hdr, _deltaBuffers[i], &p.endpoint});
+    p.sentSnapshots.push(sequence, current);
+  }
+  _socket.send_batch(_outgoing);
+}
+
+std::shared_ptr<snapshot::States> room::acquire_snapshot_states()
+{
+  // Each player's history holds its own last CAPACITY snapshots, so players x CAPACITY + 1
+  // buffers cover them plus the one being built; a buffer only the pool still owns is free
+  for (auto &states : _snapshotStates)
+  {
+    if (states.use_count() == 1)
+    {
+      states->clear();
+      return states;
+    }
+  }
+  auto states = std::make_shared<snapshot::States>();
+  states->reserve(entity_budget);
+  _snapshotStates.push_back(states);
+  return states;
+}
+
+void room::broadcast_game_over(uint32_t winnerEntityId)
+{
+  GameOverPayload payload{winnerEntityId};
+  for (auto &p : _players)
+    _socket.send(GAME_OVER, payload, p.endpoint, _tick);
+  std::cout << "Game Over! Winner entity id: " <<  winnerEntityId << std::endl;
+}
+
+void room::check_game_over()
+{
+  auto &healths = _registry.get_components<component::health>();
+  auto &kinds = _registry.get_components<component::entity_kind>();
+
+  std::size_t alivePlayers = 0;
+  uint32_t winnerId = UINT32_MAX;
+
+  for (auto &&[i, kind] : indexed_zipper(kinds))
+  {
+    if (kind != component::entity_kind::player)
+      continue;
+    if (i < healths.size() && healths[i] && healths[i]->hp > 0)
+    {
+      if (alivePlayers++ == 0)
+        winnerId = _registry.entity_from_index(i).handle();
+    }
+  }
+  if (alivePlayers <= 1)
+  {
+    broadcast_game_over(winnerId);
+    _running = false;
+  }
+}
+
+void room::add_player(const engine::net::Endpoint &endpoint)
+{
+  std::size_t playerIndex = _players.size();
+  auto eid = spawn_player(endpoint, playerIndex);
+  PlayerInfo pi{.endpoint = endpoint, .entityId = eid};
+  pi.interest.reserve(entity_budget);
+  _live_entities.insert(static_cast<std::size_t>(eid));
+  std::cout << "[Room " << _id << "] Spawned player entity: " << eid << " for "
+            << engine::net::to_string(endpoint) << "\n";
+
+  _playerByEndpoint.emplace(endpoint, _players.size());
+  _players.push_back(std::move(pi)); // a copy would drop the reserved interest buffers
+  send_connect_ack(_players.back());
+  broadcast_snapshot();
+}
+
+bool room::has_player(const engine::net::Endpoint &endpoint) const
+{
+  return _playerByEndpoint.count(endpoint) != 0;
+}
+
+PlayerInfo *room::find_player(const engine::net::Endpoint &endpoint)
+{
+  auto it = _playerByEndpoint.find(endpoint);
+  return it != _playerByEndpoint.end() ? &_players[it->second] : nullptr;
+}
+
+void room::send_connect_ack(const PlayerInfo &player)
+{
+  ConnectAck ack{1234, _tickRate, player.entityId.handle()};
+  _socket.send(CONNECT_ACK, ack, player.endpoint);
+}
+
+void room::handle_packet(const PacketHeader &hdr, std::span<const uint8_t> payload,
+                         const engine::net::Endpoint &sender)
+{
+  if (hdr.type == INPUT_PKT)
+  {
+    handle_input(payload, sender);
+  }
+  else if (hdr.type == CONNECT_REQ)
+  {
+    // Retried handshake (lost ack): acknowledge again instead of spawning a second player
+    if (PlayerInfo *p = find_player(sender))
+      send_connect_ack(*p);
+  }
+}
+
+void room::handle_input(std::span<const uint8_t> payload, const engine::net::Endpoint &sender)
+{
+  if (payload.size() < sizeof(InputPacket))
+    return;
+  InputPacket input{};
+  std::memcpy(&input, payload.data(), sizeof(InputPacket));
+
+  // Inputs only count from the endpoint that owns the entity they name
+  PlayerInfo *player = find_player(sender);
+  if (!player || player->entityId.handle() != input.clientId)
+    return;
+  PlayerInfo &p = *player;
+  if (input.ackSequence != SNAPSHOT_NO_BASELINE && input.ackSequence < _snapshotSequence &&
+      (p.ackSequence == SNAPSHOT_NO_BASELINE || input.ackSequence > p.ackSequence))
+  {
+    p.ackSequence = input.ackSequence;
+    if (_snapshotSequence - input.ackSequence <= snapshot::History::CAPACITY)
+    {
+      // Exponential average as for TCP's SRTT: one late ack does not swing the estimate
+      std::chrono::duration<float, std::milli> sample =
+          std::chrono::steady_clock::now() - _snapshotSentAt[input.ackSequence % snapshot::History::CAPACITY];
+      p.rttMs = p.rttMs == 0.f ? sample.count() : p.rttMs + (sample.count() - p.rttMs) / 8.f;
+    }
+  }
+  // Reordered packet: a newer input already set the held actions
+  if (p.inputTick != INPUT_NO_TICK && input.tick <= p.inputTick)
+    return;
+  p.inputTick = input.tick;
+  const uint8_t actions = input.actions;
+  auto &velocities = _registry.get_components<component::velocity>();
+  if (static_cast<size_t>(p.entityId) < velocities.size() && velocities[p.entityId])
+    *velocities[p.entityId] = player_velocity(actions);
+
+  // Shots fired now hit the enemies where this client drew them, up to the history depth
+  uint32_t rewind = 0;
+  if (input.viewTick != INPUT_NO_TICK && input.viewTick < _tick)
+    rewind = std::min<uint32_t>(_tick - input.viewTick, static_cast<uint32_t>(_lagHistory.depth()));
+  auto compensate = [&](engine::entity_t shot) {
+    auto &tags = _registry.get_components<component::projectile_tag>();
+    if (shot != p.entityId && static_cast<size_t>(shot) < tags.size() && tags[shot])
+      tags[shot]->rewindTicks = rewind;
+  };
+
+  const uint8_t pressed = actions & ~p.prevActions;
+  const uint8_t released = p.prevActions & ~actions;
+  constexpr uint32_t CHARGE_TICKS = 30;
+  if (pressed & INPUT_FIRE) {
+    p.firePressTick = _tick;
+  }
+  if (released & INPUT_FIRE) {
+    uint32_t held = (_tick > p.firePressTick) ? (_tick - p.firePressTick) : 0;
+    engine::entity_t e = (held >= CHARGE_TICKS) ? spawn_projectile_charged(p.entityId, held) : spawn_projectile_basic(p.entityId);
+    compensate(e);
+    _live_entities.insert(static_cast<std::size_t>(e));
+  }
+  if (pressed & INPUT_BOMB) {
+    auto e = spawn_projectile_bomb(p.entityId);
+    compensate(e);
+    _live_entities.insert(static_cast<std::size_t>(e));
+  }
+  p.prevActions = actions;
+}
+
+engine::entity_t room::spawn_projectile_basic(engine::entity_t owner)
+{
+    auto &positions = _registry.get_components<component::position>();
+    auto &hitboxes = _registry.get_components<component::hitbox>();
+    size_t idx = static_cast<size_t>(owner);
+    if (idx >= positions.size() || !positions[idx]) return owner;
+    auto pos = positions[idx].value();
+    float playerW = 0.f, playerH = 0.f;
+    if (idx < hitboxes.size() && hitboxes[idx]) { playerW = hitboxes[idx]->width; playerH = hitboxes[idx]->height; }
+    constexpr float w = 10.f, h = 10.f;
+    float startX = pos.x + playerW + 4.f;
+    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
+    return engine::make_entity(
+        _registry,
+    component::position{startX, startY}, component::velocity{1.f, 0.f},
+        component::hitbox{w, h},
+        component::collision_state{false},
+        component::entity_kind::playerProjectile,
+        component::projectile_tag{owner.handle(), 120, 1.f, 0.f, 2.0f, 2},
+        component::health{1});
+}
+
+engine::entity_t room::spawn_projectile_alt(engine::entity_t owner)
+{
+    auto &positions = _registry.get_components<component::position>();
+    auto &hitboxes = _registry.get_components<component::hitbox>();
+    size_t idx = static_cast<size_t>(owner);
+    if (idx >= positions.size() || !positions[idx]) return owner;
+    auto pos = positions[idx].value();
+    float playerW = 0.f, playerH = 0.f;
+    if (idx < hitboxes.size() && hitboxes[idx]) { playerW = hitboxes[idx]->width; playerH = hitboxes[idx]->height; }
+    constexpr float w = 12.f, h = 12.f;
+    float startX = pos.x + playerW + 4.f;
+    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
+    return engine::make_entity(
+        _registry,
+    component::position{startX, startY}, component::velocity{1.f, 0.f},
+        component::hitbox{w, h},
+        component::collision_state{false},
+        component::entity_kind::playerProjectile,
+        component::projectile_tag{owner.handle(), 120, 1.f, 0.f, 3.0f, 2},
+        component::health{1});
+}
+
+engine::entity_t room::spawn_projectile_charged(engine::entity_t owner, uint32_t heldTicks)
+{
+    auto &positions = _registry.get_components<component::position>();
+    auto &hitboxes = _registry.get_components<component::hitbox>();
+    size_t idx = static_cast<size_t>(owner);
+    if (idx >= positions.size() || !positions[idx])
+        return owner;
+    auto pos = positions[idx].value();
+    float playerW = 0.f, playerH = 0.f;
+    if (idx < hitboxes.size() && hitboxes[idx]) {
+        playerW = hitboxes[idx]->width;
+        playerH = hitboxes[idx]->height;
+    }
+    float scale = std::min(1.0f + (heldTicks / 60.0f), 3.0f);
+    float w = 14.f * scale, h = 14.f * scale;
+    float speed = 5.5f + 1.0f * scale;
+    int dmg = static_cast<int>(2 * scale) + 1;
+    float startX = pos.x + playerW + 4.f;
+    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
+    return engine::make_entity(
+        _registry,
+    component::position{startX, startY}, component::velocity{speed, 0.f},
+        component::hitbox{w, h},
+        component::collision_state{false},
+        component::entity_kind::projectile_charged,
+        component::projectile_tag{owner.handle(), 180, 1.f, 0.f, speed, dmg},
+        component::health{1});
+}
+
+engine::entity_t room::spawn_projectile_bomb(engine::entity_t owner)
+{
+  auto &positions = _registry.get_components<component::position>();
+  auto &hitboxes = _registry.get_components<component::hitbox>();
+  size_t idx = static_cast<size_t>(owner);
+  if (idx >= positions.size() || !positions[idx])
+    return owner;
+  auto pos = positions[idx].value();
+  float playerW = 0.f, playerH = 0.f;
+  if (idx < hitboxes.size() && hitboxes[idx]) { 
+    playerW = hitboxes[idx]->width;
+    playerH = hitboxes[idx]->height;
+  }
+
+  constexpr float w = 17.f, h = 17.f;
+  float startX = pos.x + playerW - w * 0.2f;
+  float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
+
+  float dirX = 0.8f;
+  float dirY = -0.9f;
+  float speed = 2.2f;
+  uint32_t lifetime = 240;
+  int damage = 3;
+
+  return engine::make_entity(
+    _registry,
+    component::position{startX, startY}, component::velocity{dirX * speed, dirY * speed},
+    component::hitbox{w, h},
+    component::collision_state{false},
+    component::entity_kind::projectile_bomb,
+    component::projectile_tag{owner.handle(), lifetime, dirX, dirY, speed, damage},
+    component::gravity{0.03f},
+    component::health{1}
+  );
+}
+
+engine::entity_t room::spawn_player(engine::net::Endpoint endpoint, std::size_t index)
+{
+  float spawnX = 100.f;
+  float spawnY = 100.f + 120.f * static_cast<float>(index);
+  auto eid = engine::make_entity(
+      _registry, component::position{spawnX, spawnY}, component::velocity{0, 0},
+      component::hitbox{124, 70}, component::controllable{},
+      component::collision_state{false}, component::health{20},
+      component::damage{0}, component::entity_kind::player,
+      component::controlled_by{static_cast<uint32_t>(index)},
+      component::damage_cooldown{0});
+  return eid;
+}
+
+engine::entity_t room::spawn_projectile(engine::entity_t owner)
+{
+    auto &positions = _registry.get_components<component::position>();
+    auto &hitboxes = _registry.get_components<component::hitbox>();
+    size_t idx = static_cast<size_t>(owner);
+    if (idx >= positions.size() || !positions[idx])
+        return owner;
+    auto pos = positions[idx].value();
+    float playerW = 0.f, playerH = 0.f;
+    if (idx < hitboxes.size() && hitboxes[idx])
+    {
+        playerW = hitboxes[idx]->width;
+        playerH = hitboxes[idx]->height;
+    }
+    constexpr float projectileW = 72.f;
+    constexpr float projectileH = 24.f;
+    float startX = pos.x + playerW + 4.f;
+    float startY = pos.y + (playerH * 0.5f) - (projectileH * 0.5f);
+    auto proj = engine::make_entity(
+        _registry,
+    component::position{startX, startY}, component::velocity{2.f, 0.f},
+        component::hitbox{projectileW, projectileH},
+        component::collision_state{false},
+        component::entity_kind::playerProjectile,
+        component::projectile_tag{owner.handle(), 120, 1.f, 0.f, 2.f, 2},
+        component::health{1});
+    return proj;
+}
+
+void room::despawn(engine::entity_t e)
+{
+  _registry.commands().defer([this, e](engine::registry &reg) {
+    if (!reg.is_alive(e))
+      return;
+    _live_entities.erase(static_cast<std::size_t>(e));
+    reg.kill_entity(e);
+  });
+}
+
+engine::entity_t room::spawn_missile_explosion(float x, float y, int damage, float radius)
+{
+  float size = radius * 2.f;
+  float topLeftX = x - radius;
+  float topLeftY = y - radius;
+  auto e = engine::make_entity(
+    _registry,
+    component::position{topLeftX, topLeftY},
+    component::velocity{0.f, 0.f},
+    component::hitbox{size, size},
+    component::collision_state{false},
+    component::entity_kind::missile_explosion,
+    component::projectile_tag{0u, 30u, 0.f, 0.f, 0.f, damage},
+    component::area_effect{radius, damage, false},
+    component::health{1});
+  return e;
+}
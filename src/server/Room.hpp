@@ -0,0 +1,214 @@
+#pragma once
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <random>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include "LevelManager.hpp"
+#include "engine/ecs/EntitySet.hpp"
+#include "engine/ecs/Registry.hpp"
+#include "engine/ecs/Components.hpp"
+#include "engine/ecs/Collision.hpp"
+#include "common/Packets.hpp"
+#include "common/SnapshotDelta.hpp"
+#include "engine/network/UdpSocket.hpp"
+#include "engine/network/Endpoint.hpp"
+#include "engine/threading/SpscQueue.hpp"
+#include "engine/threading/ThreadPool.hpp"
+#include "engine/memory/BumpArena.hpp"
+#include "common/PlayerMovement.hpp"
+#include "LagCompensation.hpp"
+#include "Interest.hpp"
+/**
+ * @class room
+ * @brief One match: game state, player entities and level progression of a group of players.
+ *
+ * A room owns its own ECS registry, tick counter and LevelManager, so several matches run
+ * side by side in one server process. It does not own the network: the lobby (see server)
+ * shares one UDP socket between all rooms, queues each packet in the inbox of its sender's
+ * room and calls tick() at the server tick rate once the room is full.
+ *
+ * Rooms share no mutable state, so the lobby ticks them in parallel. A room is only ever
+ * used by one thread at a time except for enqueue(), which the network thread calls while
+ * the room ticks; packets are applied in arrival order at the start of the next tick, which
+ * keeps each match deterministic regardless of which worker runs it.
+ *
+ * @note Networking is provided via engine wrappers; Asio is encapsulated inside the engine.
+ *
+ * @section Responsibilities
+ * - Registers players that the lobby assigns to it.
+ * - Handles game phases: processing inputs, updating game state, and broadcasting snapshots.
+ * - Spawns and manages player and projectile entities.
+ * - Centralizes entity removal logic to maintain ECS pipeline integrity.
+ *
+ * @section Members
+ * - _registry: ECS registry for managing entities and components.
+ * - _socket: UDP socket shared with the other rooms, used to send to this room's players.
+ * - _players: Session of each connected client (entity, snapshot acks, input state, RTT),
+ *   indexed by endpoint in _playerByEndpoint.
+ * - _inbox: Packets received for this room and not yet handled.
+ * - _live_entities: Indices of the currently active entities (a bitset, no per-spawn allocation).
+ * - _tick: Current room tick for synchronization.
+ * - _gen: Random number generator for entity spawning and game logic.
+ */
+// Session of one connected client: everything handling its packets needs, in one place
+struct PlayerInfo
+{
+    engine::net::Endpoint endpoint;
+    engine::entity_t entityId;
+    // Delta snapshot baselines: what was sent to this client, and the last sequence it acked
+    snapshot::History sentSnapshots{};
+    uint32_t ackSequence = SNAPSHOT_NO_BASELINE;
+    // InputAction bits of the previous input packet (shots fire on edges)
+    uint8_t prevActions = 0;
+    uint32_t firePressTick = 0; // tick INPUT_FIRE went down, for charged shots
+    // Newest InputPacket::tick applied; older packets are stale. Echoed in snapshots so the
+    // client knows which of its predicted inputs the server position already includes.
+    uint32_t inputTick = INPUT_NO_TICK;
+    // What this client's snapshots carry: relevant entities by accumulated priority
+    ClientInterest interest{};
+    // Smoothed round trip from snapshot send to its ack, 0 until the first sample. Acks are
+    // read at the start of a tick, so it includes up to one tick of queueing.
+    float rttMs = 0.f;
+};
+// Packet received by the network thread, waiting in a room inbox. The payload is stored
+// inline so that queueing a packet never touches the heap.
+struct InboundPacket
+{
+    // Payload of one unfragmented datagram; clients send nothing larger to a room
+    static constexpr std::size_t max_payload = engine::net::UdpSocket::max_datagram - sizeof(PacketHeader);
+
+    PacketHeader header{};
+    std::array<uint8_t, max_payload> payload;
+    std::size_t size = 0;
+    engine::net::Endpoint sender;
+
+    // False (packet left unchanged) when `bytes` does not fit in the inline payload
+    bool assign(const PacketHeader &hdr, std::span<const uint8_t> bytes, const engine::net::Endpoint &from)
+    {
+        if (bytes.size() > max_payload)
+            return false;
+        header = hdr;
+        std::memcpy(payload.data(), bytes.data(), bytes.size());
+        size = bytes.size();
+        sender = from;
+        return true;
+    }
+    std::span<const uint8_t> bytes() const { return {payload.data(), size}; }
+};
+class room
+{
+    public:
+    static constexpr std::size_t max_players = 2;
+    static constexpr std::size_t inbox_capacity = 256;
+    // Oldest enemy state a player shot is tested against (round trip plus interpolation delay)
+    static constexpr uint32_t max_rewind_ms = 250;
+    // Ticks after a level starts during which buffers may still grow to the level's needs;
+    // later ticks are expected to make no heap allocation (tests/RoomAllocationTest.cpp)
+    static constexpr uint32_t allocation_warmup_ticks = 300;
+    // Live entities the per-entity buffers (ECS, broad phase, snapshots...) are sized for up
+    // front; a match holds a few dozen, more only costs the growth of those buffers
+    static constexpr std::size_t entity_budget = 128;
+
+    // `pool` runs the independent ECS systems of a tick in parallel; nullptr keeps them serial
+    room(engine::net::UdpSocket &socket, uint32_t id, uint32_t tickRate, engine::thread_pool *pool = nullptr);
+
+    // Lobby interface
+    void add_player(const engine::net::Endpoint &endpoint);
+    bool has_player(const engine::net::Endpoint &endpoint) const;
+    bool enqueue(InboundPacket &&packet); // network thread; false (dropped) when the inbox is full
+    void drain_inbox();
+    void tick();
+
+    uint32_t id() const { return _id; }
+    bool is_full() const { return _players.size() >= max_players; }
+    bool is_finished() const { return !_running; }
+    std::size_t entity_count() const { return _live_entities.size(); }
+    std::vector<PlayerInfo> const &players() const { return _players; }
+    // Heap allocations made by the last tick on its thread (0 unless ENGINE_COUNT_ALLOCATIONS)
+    uint64_t last_tick_allocations() const { return _tickAllocations; }
+    // True once the current level ran for allocation_warmup_ticks: ticks should not allocate
+    bool warmed_up() const { return _tick - _levelManager->levelStartTick() > allocation_warmup_ticks; }
+
+private:
+    // Initialization / registration
+    void register_components();
+    void setup_systems();
+
+    // Sub-registrations (split from setup_systems)
+    void register_health_and_spawn_systems();
+    void register_projectile_movement_system();
+    void register_gravity_system();
+    void register_collision_system();
+    void register_bounds_system();
+    void register_area_effect_system();
+
+    // Game loop phases
+    void handle_packet(const PacketHeader &hdr, std::span<const uint8_t> payload,
+                       const engine::net::Endpoint &sender);
+    void handle_input(std::span<const uint8_t> payload, const engine::net::Endpoint &sender);
+    void send_connect_ack(const PlayerInfo &player);
+    PlayerInfo *find_player(const engine::net::Endpoint &endpoint);
+    void game_handler();
+    void broadcast_snapshot();
+    void broadcast_game_over(uint32_t winnerEntityId);
+    void check_game_over();
+    // Cleared States buffer for the next snapshot, recycled once no history references it
+    std::shared_ptr<snapshot::States> acquire_snapshot_states();
+
+    // Spawning helpers
+    engine::entity_t spawn_player(engine::net::Endpoint endpoint, std::size_t index);
+    engine::entity_t spawn_projectile(engine::entity_t owner);
+    engine::entity_t spawn_projectile_basic(engine::entity_t owner);
+    engine::entity_t spawn_projectile_alt(engine::entity_t owner);
+    engine::entity_t spawn_projectile_charged(engine::entity_t owner, uint32_t heldTicks);
+    engine::entity_t spawn_projectile_bomb(engine::entity_t owner);
+    engine::entity_t spawn_missile_explosion(float x, float y, int damage, float radius);
+
+    // Records, in the registry's command buffer, the kill of the entity and its removal from
+    // the snapshot set: systems never call kill_entity while iterating, and parallel systems
+    // never write the shared live set (both are applied at the next sync point).
+    void despawn(engine::entity_t e);
+
+private:
+    bool _running = true;
+    engine::registry _registry;
+
+    engine::net::UdpSocket &_socket;
+    uint32_t _id;
+    uint32_t _tickRate;
+
+
+    engine::entity_set _live_entities; // by entity index, allocated once
+    std::vector<PlayerInfo> _players;
+    std::unordered_map<engine::net::Endpoint, std::size_t> _playerByEndpoint; // index in _players
+    engine::spsc_queue<InboundPacket> _inbox{inbox_capacity};
+    InboundPacket _pending;
+    std::unique_ptr<LevelManager> _levelManager;
+
+    uint32_t _tick = 0;
+    uint32_t _snapshotSequence = 0;
+    std::vector<std::vector<uint8_t>> _deltaBuffers; // one per player, sent as one batch
+    std::vector<engine::net::UdpSocket::OutgoingDatagram> _outgoing;
+    // Send time of the last History::CAPACITY snapshots, by sequence, for RTT samples
+    std::array<std::chrono::steady_clock::time_point, snapshot::History::CAPACITY> _snapshotSentAt{};
+    snapshot::States _worldStates; // every entity this tick, before per-client selection
+    std::vector<std::shared_ptr<snapshot::States>> _snapshotStates; // at most players x History::CAPACITY + 1
+
+    // Per-tick scratch memory (collision flags, snapshot dedup...), reset when a tick starts,
+    // so a steady-state tick reuses what earlier ticks grew instead of hitting the heap
+    engine::bump_arena _frameArena;
+    uint64_t _tickAllocations = 0;
+
+    // Collision broad phase (grid buffers reused every tick) and allowed kind pairs
+    engine::spatial_hash _broadphase;
+    engine::collision_matrix _collisionMatrix;
+    // Enemy hitboxes of the last ticks, for lag-compensated player shots
+    LagHistory _lagHistory;
+
+    std::random_device rd;
+    std::mt19937 _gen{rd()};
+};
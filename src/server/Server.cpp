@@ -1,839 +1,221 @@
 /**
  * @file Server.cpp
- * @brief Implementation of the main server logic for the R-Type game.
+ * @brief Implementation of the R-Type server lobby.
  *
- * This file contains the core server-side logic, including entity management,
- * network communication, game tick handling, system registration, and enemy spawning.
- * The server uses an ECS (Entity Component System) architecture to manage game entities
- * and their behaviors, and communicates with clients via UDP sockets.
- *
- * Main functionalities:
- * - Registers and manages game components and systems.
- * - Handles player connections and spawns player entities.
- * - Processes network inputs from clients to update player states.
- * - Spawns enemies and projectiles at regular intervals based on game ticks.
- * - Runs game logic and updates entity states each tick.
- * - Broadcasts game state snapshots to all connected players.
- *
- * Key classes and functions:
- * - server::server: Constructor, initializes server and registers components/systems.
- * - server::run: Main game loop, processes inputs, updates game state, and broadcasts snapshots.
- * - server::register_components: Registers all ECS components used in the game.
- * - server::setup_systems: Registers all ECS systems, including AI and collision handling.
- * - server::game_handler: Spawns enemies and handles game-specific logic per tick.
- * - server::broadcast_snapshot: Sends the current game state to all players.
- * - server::wait_for_players: Waits for player connections and spawns player entities.
- * - server::process_network_inputs: Handles incoming network packets and updates player states.
- * - server::spawn_player: Spawns a new player entity with default components.
- * - server::spawn_projectile: Spawns a projectile entity for a given owner.
+ * The lobby accepts connections, groups players into rooms (independent matches) and drives
+ * them on two kinds of threads: a network thread that sleeps on the socket and queues every
+ * received packet in its room's inbox, and the main thread that sleeps until the next tick
+ * deadline, seats new players and ticks every running room in parallel on the worker pool.
  *
+ * Key functions:
+ * - server::run: Main loop, starts the network thread, seats players and ticks rooms.
+ * - server::network_loop: Network thread, waits for datagrams and dispatches them.
+ * - server::dispatch_packets: Routes each packet to the inbox of its sender's room.
+ * - server::connect_player: Places a new endpoint in the open room, creating it if needed.
+ * - server::tick_rooms: One parallel tick of every full room.
+ * - server::close_finished_rooms: Drops rooms whose match is over.
  */
-#include "engine/ecs/Systems.hpp"
-#include "engine/ecs/EntityFactory.hpp"
-#include "engine/events/Events.hpp"
-#include "server/ServerUtils.hpp"
+#include "Server.hpp"
+#include "common/Accessibility.hpp"
 #include "engine/profiling/Profiler.hpp"
+#include "engine/profiling/AllocationCounter.hpp"
+#include "server/System_ai.hpp"
+#include <algorithm>
 #include <chrono>
-#include <fstream>
 #include <iostream>
-#include <nlohmann/json.hpp>
-#include <random>
-#include <thread>
-
-#include "common/Components_client.hpp"
-#include "engine/ecs/Systems.hpp"
-#include "server/Components_ai.hpp"
-#include "server/EnemyConfig.hpp"
-#include "common/Accessibility.hpp"
-#include "server/System_ai.hpp"
-#include "Server.hpp"
-
-using json = nlohmann::json;
 
-using namespace serverutils;
-
-server::server(engine::net::IoContext &ctx, unsigned short port)
-    : _socket(ctx, port), _io(ctx), _port(port)
+namespace
 {
-  register_components();
-  _levelManager = std::make_unique<LevelManager>(_registry, _socket, _players, _tick, _live_entities);
+  // Upper bound on how long route changes wait for the network thread when no packet arrives
+  constexpr auto network_poll_interval = std::chrono::milliseconds(10);
 }
 
-// Default components
-void server::register_components()
+server::server(engine::net::IoContext &ctx, unsigned short port, uint32_t tickRate,
+               TickScheduler::CatchUp catchUp, uint32_t maxCatchUp, std::size_t workers)
+    : _socket(ctx, port), _scheduler(tickRate, catchUp, maxCatchUp), _pool(workers)
 {
   AccessibilityConfig::load_from_json("configs/accessibility_config.json");
-
-  _registry.register_component<component::position>();
-  _registry.register_component<component::velocity>();
-  _registry.register_component<component::hitbox>();
-  _registry.register_component<component::controllable>();
-  _registry.register_component<component::collision_state>();
-  _registry.register_component<component::health>();
-  _registry.register_component<component::damage>();
-  _registry.register_component<component::spawn_request>();
-  _registry.register_component<component::entity_kind>();
-  _registry.register_component<component::controlled_by>();
-  _registry.register_component<component::damage_cooldown>();
-  _registry.register_component<component::projectile_tag>();
-  // New modular components
-  _registry.register_component<component::gravity>();
-  _registry.register_component<component::area_effect>();
-
   systems::init_ai_behaviors();
-  _registry.add_system<component::position, component::velocity,
-                       component::ai_controller>(
-      [this](auto &reg, auto &pos, auto &vel, auto &ai)
-      {
-        systems::enemy_ai_system(reg, pos, vel, ai, _tick);
-      });
-  _registry.register_component<component::ai_controller>();
-  _registry.register_component<component::spell>();
-  _registry.register_component<component::spellbook>();
-  _registry.register_component<component::boss_phase>();
+}
 
-  setup_systems();
+server::~server()
+{
+  _running = false;
+  if (_networkThread.joinable())
+    _networkThread.join();
 }
 
 void server::run()
 {
-  wait_for_players();
-  std::cout << "All players connected!\n";
+  std::cout << "Waiting for players (" << room::max_players << " per room, "
+            << _pool.size() + 1 << " simulation threads)..." << std::endl;
 
   auto& profiler = Engine::Profiling::Profiler::getInstance();
   uint32_t frameCounter = 0;
 
-  using clock = std::chrono::steady_clock;
-  const auto tick_duration = std::chrono::milliseconds(16);
-  auto last_tick = clock::now();
+  _scheduler.reset();
+  _networkThread = std::thread(&server::network_loop, this);
 
   while (_running)
   {
+    // Packets are queued by the network thread meanwhile, so only the tick clock matters here
+    std::this_thread::sleep_until(_scheduler.next_deadline());
+
     profiler.beginFrame();
 
     {
-      PROFILE_SCOPE("Network Input");
-      process_network_inputs();
+      PROFILE_SCOPE("Accept Connections");
+      accept_connections();
     }
 
-    auto now = clock::now();
-    if (now - last_tick >= tick_duration)
+    uint32_t dueTicks = _scheduler.due(TickScheduler::clock::now());
+    for (uint32_t i = 0; i < dueTicks && _running; ++i)
     {
       PROFILE_SCOPE("Game Tick");
-      auto &positions = _registry.get_components<component::position>();
-      auto &velocities = _registry.get_components<component::velocity>();
-      auto &controls = _registry.get_components<component::controllable>();
-      
-      {
-        PROFILE_SCOPE("Game Handler");
-        game_handler();
-      }
-      
-      {
-        PROFILE_SCOPE("Physics Systems");
-        float dt = 1.0f / 60.0f;
-        float speedFactor = AccessibilityConfig::enabled ? AccessibilityConfig::speed_game : 1.0f;
-        position_system(_registry, positions, velocities, dt * speedFactor);
-        _registry.run_systems();
-      }
-      
-      {
-        PROFILE_SCOPE("Broadcast Snapshot");
-        broadcast_snapshot();
-      }
-      
-      check_game_over();
-      _tick++;
-
-      last_tick += tick_duration;
-
-      if (now - last_tick >= tick_duration)
-      {
-        last_tick = now;
-      }
+      tick_rooms();
     }
+    close_finished_rooms();
 
     profiler.endFrame();
-    
+
     if (++frameCounter % 300 == 0) {
       profiler.updateMemoryMetrics();
       profiler.updateCPUMetrics();
-      profiler.setEntityCount(_live_entities.size());
-      
-      const auto& frameMetrics = profiler.getFrameMetrics();
-      const auto& memMetrics = profiler.getMemoryMetrics();
-      
-      // std::cout << "[Profiling] FPS: " << std::fixed << std::setprecision(1) << frameMetrics.displayFps
-      //           << " | Frame: " << frameMetrics.displayFrameTime << "ms"
-      //           << " | Entities: " << _live_entities.size()
-      //           << " | Memory: " << (memMetrics.physicalMemoryUsed / 1024.0 / 1024.0) << "MB\n";
+      std::size_t entities = 0;
+      for (auto &r : _rooms)
+        entities += r->entity_count();
+      profiler.setEntityCount(entities);
+      // Steady-state ticks are expected not to allocate at all
+      if constexpr (Engine::Profiling::allocationCountingEnabled())
+      {
+        std::cout << "[Profiling] Heap allocations in room ticks over the last 300 frames: "
+                  << _tickAllocations << "\n";
+        _tickAllocations = 0;
+      }
     }
   }
-}
 
-void server::stop() { _running = false; }
-
-void server::setup_systems()
-{
-  register_health_and_spawn_systems();
-  register_projectile_movement_system();
-  register_gravity_system();
-  register_collision_system();
-  register_bounds_system();
-  register_area_effect_system();
-}
-
-void server::register_health_and_spawn_systems()
-{
-  _registry.add_system<component::health, component::damage>(health_system);
-  _registry.add_system<component::spawn_request>(spawn_system);
-}
-
-void server::register_projectile_movement_system()
-{
-  _registry.add_system<component::position, component::projectile_tag>(
-      [this](engine::registry &reg,
-             engine::sparse_array<component::position> &positions,
-             engine::sparse_array<component::projectile_tag> &projectiles) {
-        std::vector<engine::entity_t> toKill;
-        for (auto &&[i, pos, proj] : indexed_zipper(positions, projectiles))
-        {
-          pos.x += proj.dirX * proj.speed;
-          pos.y += proj.dirY * proj.speed;
-          if (proj.lifetime > 0)
-            --proj.lifetime;
-          if (proj.lifetime <= 0)
-            toKill.push_back(reg.entity_from_index(i));
-        }
-        for (auto e : toKill)
-        {
-          _live_entities.erase(static_cast<uint32_t>(e));
-          reg.kill_entity(e);
-        }
-      });
-}
-
-void server::register_gravity_system()
-{
-  _registry.add_system<component::projectile_tag, component::gravity, component::velocity>(
-      [this](engine::registry &reg,
-             engine::sparse_array<component::projectile_tag> &projectiles,
-             engine::sparse_array<component::gravity> &gravs,
-             engine::sparse_array<component::velocity> &vels) {
-        for (auto &&[i, proj, g, vel] : indexed_zipper(projectiles, gravs, vels))
-        {
-          (void)i;
-          proj.dirY += g.ay;
-          vel.vx = proj.dirX * proj.speed;
-          vel.vy = proj.dirY * proj.speed;
-        }
-      });
-}
-
-void server::register_collision_system()
-{
-  _registry.add_system<component::position, component::hitbox>(
-      [this](engine::registry &reg,
-             engine::sparse_array<component::position> &positions,
-             engine::sparse_array<component::hitbox> &hitboxes) {
-        auto &collisions = _registry.get_components<component::collision_state>();
-        auto &velocities = _registry.get_components<component::velocity>();
-        auto &kinds = _registry.get_components<component::entity_kind>();
-        auto &damages = _registry.get_components<component::damage>();
-        auto &cooldowns = _registry.get_components<component::damage_cooldown>();
-        auto &projectiles = _registry.get_components<component::projectile_tag>();
-        std::vector<bool> newCollided(collisions.size(), false);
-
-        hitbox_system(reg, positions, hitboxes, [&](std::size_t i, std::size_t j) {
-          auto kindI = (i < kinds.size() && kinds[i]) ? kinds[i].value() : component::entity_kind::unknown;
-          auto kindJ = (j < kinds.size() && kinds[j]) ? kinds[j].value() : component::entity_kind::unknown;
-
-          if (kindI == component::entity_kind::player && kindJ == component::entity_kind::enemy)
-          {
-            apply_damage_with_cooldown(i, _tick, reg, damages, cooldowns, collisions);
-            newCollided[i] = true;
-            resolve_block(i, j, positions, hitboxes, collisions, velocities);
-          }
-          if (kindJ == component::entity_kind::player && kindI == component::entity_kind::enemy)
-          {
-            apply_damage_with_cooldown(j, _tick, reg, damages, cooldowns, collisions);
-            newCollided[j] = true;
-            resolve_block(j, i, positions, hitboxes, collisions, velocities);
-          }
-
-          if ((kindI == component::entity_kind::playerProjectile || kindI == component::entity_kind::projectile_bomb || kindI == component::entity_kind::projectile_charged) &&
-              kindJ == component::entity_kind::enemy)
-          {
-            if (i < projectiles.size() && projectiles[i])
-            {
-              auto &proj = projectiles[i].value();
-              auto ownerKind = (proj.owner < kinds.size() && kinds[proj.owner]) ? kinds[proj.owner].value() : component::entity_kind::unknown;
-              if (ownerKind != component::entity_kind::enemy)
-              {
-                if (j < damages.size() && damages[j]) damages[j]->amount += proj.damage;
-                else reg.add_component(reg.entity_from_index(j), component::damage{proj.damage});
-                if (kindI == component::entity_kind::projectile_bomb)
-                {
-                  auto &posArr = _registry.get_components<component::position>();
-                  if (i < posArr.size() && posArr[i])
-                  {
-                    auto pPos = posArr[i].value();
-                    auto exp = spawn_missile_explosion(pPos.x, pPos.y, proj.damage, 180.f);
-                    _live_entities.insert(static_cast<uint32_t>(exp));
-                  }
-                }
-                _live_entities.erase(static_cast<uint32_t>(reg.entity_from_index(i)));
-                reg.kill_entity(reg.entity_from_index(i));
-              }
-            }
-          }
-
-          if ((kindJ == component::entity_kind::playerProjectile || kindJ == component::entity_kind::projectile_charged || kindJ == component::entity_kind::projectile_bomb) &&
-              kindI == component::entity_kind::enemy)
-          {
-            if (j < projectiles.size() && projectiles[j])
-            {
-              auto &proj = projectiles[j].value();
-              auto ownerKind = (proj.owner < kinds.size() && kinds[proj.owner]) ? kinds[proj.owner].value() : component::entity_kind::unknown;
-              if (ownerKind != component::entity_kind::enemy)
-              {
-                if (i < damages.size() && damages[i]) damages[i]->amount += proj.damage;
-                else reg.add_component(reg.entity_from_index(i), component::damage{proj.damage});
-                if (kindJ == component::entity_kind::projectile_bomb)
-                {
-                  auto &posArr = _registry.get_components<component::position>();
-                  if (j < posArr.size() && posArr[j])
-                  {
-                    auto pPos = posArr[j].value();
-                    auto exp = spawn_missile_explosion(pPos.x, pPos.y, proj.damage, 180.f);
-                    _live_entities.insert(static_cast<uint32_t>(exp));
-                  }
-                }
-                _live_entities.erase(static_cast<uint32_t>(reg.entity_from_index(j)));
-                reg.kill_entity(reg.entity_from_index(j));
-              }
-            }
-          }
-
-          if ((kindI == component::entity_kind::enemyProjectile || kindI == component::entity_kind::projectile_bomb) && kindJ == component::entity_kind::player)
-          {
-            if (i < projectiles.size() && projectiles[i])
-            {
-              auto &proj = projectiles[i].value();
-              auto ownerKind = (proj.owner < kinds.size() && kinds[proj.owner]) ? kinds[proj.owner].value() : component::entity_kind::unknown;
-              if (ownerKind != component::entity_kind::player)
-              {
-                if (j < damages.size() && damages[j]) damages[j]->amount += proj.damage;
-                else reg.add_component(reg.entity_from_index(j), component::damage{proj.damage});
-                _live_entities.erase(static_cast<uint32_t>(reg.entity_from_index(i)));
-                reg.kill_entity(reg.entity_from_index(i));
-              }
-            }
-          }
-
-          if ((kindJ == component::entity_kind::enemyProjectile || kindJ == component::entity_kind::projectile_bomb) && kindI == component::entity_kind::player)
-          {
-            if (j < projectiles.size() && projectiles[j])
-            {
-              auto &proj = projectiles[j].value();
-              auto ownerKind = (proj.owner < kinds.size() && kinds[proj.owner]) ? kinds[proj.owner].value() : component::entity_kind::unknown;
-              if (ownerKind != component::entity_kind::player)
-              {
-                if (i < damages.size() && damages[i]) damages[i]->amount += proj.damage;
-                else reg.add_component(reg.entity_from_index(i), component::damage{proj.damage});
-                _live_entities.erase(static_cast<uint32_t>(reg.entity_from_index(j)));
-                reg.kill_entity(reg.entity_from_index(j));
-              }
-            }
-          }
-        });
-
-        for (std::size_t idx = 0; idx < collisions.size(); ++idx)
-        {
-          if (collisions[idx]) collisions[idx]->collided = newCollided[idx];
-        }
-      });
+  _running = false;
+  _networkThread.join();
 }
 
-void server::register_bounds_system()
-{
-  _registry.add_system<component::position, component::velocity, component::entity_kind>(
-      [this](engine::registry &reg,
-             engine::sparse_array<component::position> &positions,
-             engine::sparse_array<component::velocity> &velocities,
-             engine::sparse_array<component::entity_kind> &kinds) {
-        std::vector<engine::entity_t> toKill;
-        for (auto &&[i, pos, vel, kind] : engine::indexed_zipper(positions, velocities, kinds))
-        {
-          float x = pos.x;
-          float y = pos.y;
-
-          if (kind == component::entity_kind::playerProjectile || kind == component::entity_kind::enemyProjectile)
-          {
-            if (x < -50.f || x > SCREEN_WIDTH + 50.f || y < -50.f || y > SCREEN_HEIGHT + 50.f)
-            {
-              toKill.push_back(reg.entity_from_index(i));
-            }
-            continue;
-          }
-
-          bool corrected = false;
-          if (x < -90.f && kind == component::entity_kind::enemy) {
-            x = SCREEN_WIDTH + 100;
-            corrected = true;
-          }
-          else if (x < 0.f && kind != component::entity_kind::enemy) { x = 0.f; corrected = true; }
-          else if (x > SCREEN_WIDTH) { x = SCREEN_WIDTH; corrected = true; }
-          if (y < 0.f) { y = 0.f; corrected = true; }
-          else if (y > SCREEN_HEIGHT) { y = SCREEN_HEIGHT; corrected = true; }
-          if (corrected)
-          {
-            pos.x = x;
-            pos.y = y;
-            vel.vx = (x <= 0.f || x >= SCREEN_WIDTH) ? 0.f : vel.vx;
-            vel.vy = (y <= 0.f || y >= SCREEN_HEIGHT) ? 0.f : vel.vy;
-          }
-        }
-
-        for (auto e : toKill)
-        {
-          _live_entities.erase(static_cast<uint32_t>(e));
-          reg.kill_entity(e);
-        }
-      });
-}
-
-void server::register_area_effect_system()
-{
-  _registry.add_system<component::position, component::area_effect, component::entity_kind>(
-      [this](engine::registry &reg,
-             engine::sparse_array<component::position> &positions,
-             engine::sparse_array<component::area_effect> &areas,
-             engine::sparse_array<component::entity_kind> &kinds) {
-        auto &damages = _registry.get_components<component::damage>();
-        for (auto &&[i, pos, area, kind] : indexed_zipper(positions, areas, kinds))
-        {
-          (void)i;
-          if (kind != component::entity_kind::missile_explosion) continue;
-          if (area.applied) continue;
-          auto &kindsArr = _registry.get_components<component::entity_kind>();
-          auto &posArr = _registry.get_components<component::position>();
-          for (size_t j = 0; j < kindsArr.size(); ++j)
-          {
-            if (j >= posArr.size() || !kindsArr[j] || !posArr[j]) continue;
-            if (kindsArr[j].value() != component::entity_kind::enemy) continue;
-            float centerX = pos.x + (area.radius);
-            float centerY = pos.y + (area.radius);
-            auto ep = posArr[j].value();
-            float dx = ep.x - centerX;
-            float dy = ep.y - centerY;
-            if ((dx * dx + dy * dy) <= area.radius * area.radius)
-            {
-              if (j < damages.size() && damages[j]) damages[j]->amount += area.damage;
-              else reg.add_component(reg.entity_from_index(j), component::damage{area.damage});
-            }
-          }
-          area.applied = true;
-        }
-      });
-}
-
-void server::game_handler()
-{
-  for (auto &p : _players)
-  {
-    _live_entities.insert(static_cast<uint32_t>(p.entityId));
-  }
-  for (auto e : systems::spawned_projectiles)
-  {
-    _live_entities.insert(static_cast<uint32_t>(e));
-  }
-  _levelManager->update();
-
-  if (_levelManager->_noMoreLevels)
-  {
-    auto &healths = _registry.get_components<component::health>();
-    auto &kinds   = _registry.get_components<component::entity_kind>();
-    std::vector<uint32_t> alivePlayers;
+void server::stop() { _running = false; }
 
-    for (auto &&[i, kind] : indexed_zipper(kinds))
-    {
-        if (kind == component::entity_kind::player)
-        {
-            if (i < healths.size() && healths[i] && healths[i]->hp > 0)
-                alivePlayers.push_back(static_cast<uint32_t>(i));
-        }
-    }
-    uint32_t winnerId = alivePlayers.empty() ? UINT32_MAX : alivePlayers[0];
-    broadcast_game_over(winnerId);
-    _running = false;
-    return;
-  }
-  systems::spawned_projectiles.clear();
-}
+// ---------------------------------------------------------------------------
+// Network thread
+// ---------------------------------------------------------------------------
 
-void server::broadcast_snapshot()
+void server::network_loop()
 {
-  auto &positions = _registry.get_components<component::position>();
-  auto &kinds = _registry.get_components<component::entity_kind>();
-  auto &collisions = _registry.get_components<component::collision_state>();
-  auto &healths = _registry.get_components<component::health>();
-  auto &velocities = _registry.get_components<component::velocity>();
-
-  constexpr std::size_t SNAPSHOT_LIMIT = 10000;
-  std::vector<EntityState> states;
-  states.reserve(50);
-  std::unordered_set<uint32_t> inserted;
-
-  auto &hitboxes = _registry.get_components<component::hitbox>();
-  SnapshotBuilderContext ctx{positions, velocities, kinds, collisions, healths, hitboxes};
-  for (auto &pInfo : _players)
-  {
-    try_add_entity(static_cast<uint32_t>(pInfo.entityId), states, ctx, inserted,
-                   SNAPSHOT_LIMIT);
-  }
-  for (uint32_t entityId : _live_entities)
+  while (_running)
   {
-
-    if (states.size() >= SNAPSHOT_LIMIT)
-      break;
-    size_t idx = static_cast<size_t>(entityId);
-    try_add_entity(entityId, states, ctx, inserted, SNAPSHOT_LIMIT);
+    _socket.wait_readable(std::chrono::steady_clock::now() + network_poll_interval);
+    apply_route_updates();
+    dispatch_packets();
   }
-  if (states.empty())
-    return;
-
-  Snapshot snap{_tick, static_cast<uint16_t>(states.size())};
-  std::vector<uint8_t> buf(sizeof(Snapshot) +
-                           sizeof(EntityState) * states.size());
-  std::memcpy(buf.data(), &snap, sizeof(Snapshot));
-  std::memcpy(buf.data() + sizeof(Snapshot), states.data(),
-              sizeof(EntityState) * states.size());
-  PacketHeader hdr{SNAPSHOT, static_cast<uint16_t>(buf.size()), _tick};
-  for (auto &p : _players)
-    _socket.send(hdr, buf, p.endpoint);
-}
-
-void server::broadcast_game_over(uint32_t winnerEntityId)
-{
-  GameOverPayload payload{winnerEntityId};
-  PacketHeader hdr{
-      GAME_OVER,
-      static_cast<uint16_t>(sizeof(payload)),
-      _tick
-  };
-  std::vector<uint8_t> data(sizeof(payload));
-  std::memcpy(data.data(), &payload, sizeof(payload));
-  for (auto &p : _players)
-    _socket.send(hdr, data, p.endpoint);
-  std::cout << "Game Over! Winner entity id: " <<  winnerEntityId << std::endl;
 }
 
-void server::check_game_over()
+void server::apply_route_updates()
 {
-  auto &healths = _registry.get_components<component::health>();
-  auto &kinds = _registry.get_components<component::entity_kind>();
-
-  std::vector<uint32_t> alivePlayers;
-
-  for (auto &&[i, kind] : indexed_zipper(kinds))
-  {
-    if (kind != component::entity_kind::player)
-      continue;
-    if (i < healths.size() && healths[i] && healths[i]->hp > 0)
-    {
-      alivePlayers.push_back(static_cast<uint32_t>(i));
-    }
-  }
-  if (alivePlayers.size() <= 1)
+  RouteUpdate update;
+  while (_routeUpdates.try_pop(update))
   {
-    uint32_t winnerId = alivePlayers.empty() ? UINT32_MAX : alivePlayers[0];
-    broadcast_game_over(winnerId);
-    _running = false;
+    _pendingConnects.erase(update.key);
+    if (update.target)
+      _routes[update.key] = std::move(update.target);
+    else
+      _routes.erase(update.key);
   }
 }
 
-void server::wait_for_players()
+void server::dispatch_packets()
 {
-  std::cout << "Waiting for 4 players..." << std::endl;
-
-  while (_players.size() < 2)
+  // One recvmmsg per batch_size datagrams instead of one receive call each
+  for (auto batch = _socket.receive_batch(); !batch.empty(); batch = _socket.receive_batch())
   {
-engine::net::Endpoint sender;
-    auto pkt_opt = _socket.receive(sender);
-    if (pkt_opt)
+    for (auto const &dgram : batch)
     {
-      auto [hdr, payload] = *pkt_opt;
-      if (hdr.type == CONNECT_REQ)
+      auto it = _routes.find(dgram.sender);
+      if (it != _routes.end())
       {
-        std::size_t playerIndex = _players.size();
-        float spawnX = 100.f;
-        float spawnY = 100.f + 120.f * static_cast<float>(playerIndex);
-
-        auto eid = spawn_player(sender, playerIndex);
-        PlayerInfo pi{sender, eid};
-        _live_entities.insert(static_cast<uint32_t>(eid));
-        std::cout << "Spawned player entity: " << eid << " for " << sender.address << ":" << sender.port
-                  << "\n";
-
-        _players.push_back(pi);
-        ConnectAck ack{1234, 60, static_cast<uint16_t>(eid)};
-        PacketHeader h{CONNECT_ACK, static_cast<uint16_t>(sizeof(ConnectAck)),
-                       0};
-        std::vector<uint8_t> buf(sizeof(ConnectAck));
-        std::memcpy(buf.data(), &ack, sizeof(ConnectAck));
-        _socket.send(h, buf, sender);
-
-        broadcast_snapshot();
+        // A full inbox means the room is far behind; dropping is what the network would do.
+        // Oversized (reassembled) messages are not room traffic and are dropped as well.
+        if (_inbound.assign(dgram.header, dgram.payload, dgram.sender))
+          it->second->enqueue(std::move(_inbound));
+        continue;
       }
+      // Handshake retries are ignored until the main thread has seated the first request
+      if (dgram.header.type == CONNECT_REQ && !_pendingConnects.count(dgram.sender) &&
+          _connectRequests.try_push(engine::net::Endpoint(dgram.sender)))
+        _pendingConnects.insert(dgram.sender);
     }
   }
 }
 
-void server::process_network_inputs()
-{
-  engine::net::Endpoint sender;
-  while (auto pkt_opt = _socket.receive(sender))
-  {
-    auto [hdr, payload] = *pkt_opt;
-    if (hdr.type == INPUT_PKT)
-    {
-      if (payload.size() >= sizeof(InputPacket))
-      {
-        InputPacket input{};
-        std::memcpy(&input, payload.data(), sizeof(InputPacket));
-
-        auto is_known = (_live_entities.find(input.clientId) != _live_entities.end());
-        if (!is_known)
-        {
-          bool is_player = std::any_of(_players.begin(), _players.end(),
-                                       [&](const PlayerInfo &p)
-                                       { return p.entityId == input.clientId; });
-          if (!is_player)
-            continue;
-        }
-                std::unordered_set<engine::R_Events::Key> keys;
-                const size_t expectedSize = sizeof(InputPacket) + static_cast<size_t>(input.keyCount) * sizeof(int32_t);
-                if (payload.size() >= expectedSize && input.keyCount > 0)
-                {
-                    const int32_t *kptr = reinterpret_cast<const int32_t *>(payload.data() + sizeof(InputPacket));
-                    for (uint16_t i = 0; i < input.keyCount; ++i)
-                        keys.insert(static_cast<engine::R_Events::Key>(kptr[i]));
-                }
-
-                for (auto &p : _players)
-                {
-                    if (p.endpoint == sender && p.entityId == input.clientId)
-                    {
-                        auto &velocities = _registry.get_components<component::velocity>();
-                        if (static_cast<size_t>(p.entityId) < velocities.size() && velocities[p.entityId])
-                        {
-                            auto &vel = *velocities[p.entityId];
-                            using engine::R_Events::Key;
-                            bool left = keys.count(Key::Left) > 0 || keys.count(Key::Q) > 0 || keys.count(Key::ControllerLeftJoystickLeft) > 0;
-                            bool right = keys.count(Key::Right) > 0 || keys.count(Key::D) > 0 || keys.count(Key::ControllerLeftJoystickRight) > 0;
-                            bool up = keys.count(Key::Up) > 0 || keys.count(Key::Z) > 0 || keys.count(Key::ControllerLeftJoystickUp) > 0;
-                            bool down = keys.count(Key::Down) > 0 || keys.count(Key::S) > 0 || keys.count(Key::ControllerLeftJoystickDown) > 0;
-                            vel.vx = left ? -PLAYER_SPEED : right ? PLAYER_SPEED : 0.f;
-                            vel.vy = up ? -PLAYER_SPEED : down ? PLAYER_SPEED : 0.f;
-                        }
-
-                        using engine::R_Events::Key;
-                        bool spaceNow = keys.count(Key::Space) > 0;
-                        bool cNow = keys.count(Key::C) > 0;
-                        bool spacePrev = (_prevSpace.find(p.entityId) != _prevSpace.end()) ? _prevSpace[p.entityId] : false;
-                        bool cPrev = (_prevC.find(p.entityId) != _prevC.end()) ? _prevC[p.entityId] : false;
-                        constexpr uint32_t CHARGE_TICKS = 30;
-                        if (spaceNow && !spacePrev) {
-                            _pressTick[p.entityId] = _tick;
-                        }
-                        if (!spaceNow && spacePrev) {
-                            uint32_t start = (_pressTick.find(p.entityId) != _pressTick.end()) ? _pressTick[p.entityId] : _tick;
-                            uint32_t held = (_tick > start) ? (_tick - start) : 0;
-                            engine::entity_t e = (held >= CHARGE_TICKS) ? spawn_projectile_charged(p.entityId, held) : spawn_projectile_basic(p.entityId);
-                            _live_entities.insert(static_cast<uint32_t>(e));
-                            _pressTick.erase(p.entityId);
-                        }
-            if (cNow && !cPrev) {
-              auto e = spawn_projectile_bomb(p.entityId);
-                            _live_entities.insert(static_cast<uint32_t>(e));
-                        }
-                        _prevSpace[p.entityId] = spaceNow;
-                        _prevC[p.entityId] = cNow;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-}
-
-engine::entity_t server::spawn_projectile_basic(engine::entity_t owner)
-{
-    auto &positions = _registry.get_components<component::position>();
-    auto &hitboxes = _registry.get_components<component::hitbox>();
-    size_t idx = static_cast<size_t>(owner);
-    if (idx >= positions.size() || !positions[idx]) return owner;
-    auto pos = positions[idx].value();
-    float playerW = 0.f, playerH = 0.f;
-    if (idx < hitboxes.size() && hitboxes[idx]) { playerW = hitboxes[idx]->width; playerH = hitboxes[idx]->height; }
-    constexpr float w = 10.f, h = 10.f;
-    float startX = pos.x + playerW + 4.f;
-    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
-    return engine::make_entity(
-        _registry,
-    component::position{startX, startY}, component::velocity{1.f, 0.f},
-        component::hitbox{w, h},
-        component::collision_state{false},
-        component::entity_kind::playerProjectile,
-        component::projectile_tag{static_cast<uint32_t>(owner), 120, 1.f, 0.f, 2.0f, 2},
-        component::health{1});
-}
-
-engine::entity_t server::spawn_projectile_alt(engine::entity_t owner)
-{
-    auto &positions = _registry.get_components<component::position>();
-    auto &hitboxes = _registry.get_components<component::hitbox>();
-    size_t idx = static_cast<size_t>(owner);
-    if (idx >= positions.size() || !positions[idx]) return owner;
-    auto pos = positions[idx].value();
-    float playerW = 0.f, playerH = 0.f;
-    if (idx < hitboxes.size() && hitboxes[idx]) { playerW = hitboxes[idx]->width; playerH = hitboxes[idx]->height; }
-    constexpr float w = 12.f, h = 12.f;
-    float startX = pos.x + playerW + 4.f;
-    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
-    return engine::make_entity(
-        _registry,
-    component::position{startX, startY}, component::velocity{1.f, 0.f},
-        component::hitbox{w, h},
-        component::collision_state{false},
-        component::entity_kind::playerProjectile,
-        component::projectile_tag{static_cast<uint32_t>(owner), 120, 1.f, 0.f, 3.0f, 2},
-        component::health{1});
-}
+// ---------------------------------------------------------------------------
+// Main thread
+// ---------------------------------------------------------------------------
 
-engine::entity_t server::spawn_projectile_charged(engine::entity_t owner, uint32_t heldTicks)
+void server::accept_connections()
 {
-    auto &positions = _registry.get_components<component::position>();
-    auto &hitboxes = _registry.get_components<component::hitbox>();
-    size_t idx = static_cast<size_t>(owner);
-    if (idx >= positions.size() || !positions[idx])
-        return owner;
-    auto pos = positions[idx].value();
-    float playerW = 0.f, playerH = 0.f;
-    if (idx < hitboxes.size() && hitboxes[idx]) {
-        playerW = hitboxes[idx]->width;
-        playerH = hitboxes[idx]->height;
-    }
-    float scale = std::min(1.0f + (heldTicks / 60.0f), 3.0f);
-    float w = 14.f * scale, h = 14.f * scale;
-    float speed = 5.5f + 1.0f * scale;
-    int dmg = static_cast<int>(2 * scale) + 1;
-    float startX = pos.x + playerW + 4.f;
-    float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
-    return engine::make_entity(
-        _registry,
-    component::position{startX, startY}, component::velocity{speed, 0.f},
-        component::hitbox{w, h},
-        component::collision_state{false},
-        component::entity_kind::projectile_charged,
-        component::projectile_tag{static_cast<uint32_t>(owner), 180, 1.f, 0.f, speed, dmg},
-        component::health{1});
+  engine::net::Endpoint endpoint;
+  while (_connectRequests.try_pop(endpoint))
+    connect_player(endpoint);
 }
 
-engine::entity_t server::spawn_projectile_bomb(engine::entity_t owner)
+void server::connect_player(const engine::net::Endpoint &sender)
 {
-  auto &positions = _registry.get_components<component::position>();
-  auto &hitboxes = _registry.get_components<component::hitbox>();
-  size_t idx = static_cast<size_t>(owner);
-  if (idx >= positions.size() || !positions[idx])
-    return owner;
-  auto pos = positions[idx].value();
-  float playerW = 0.f, playerH = 0.f;
-  if (idx < hitboxes.size() && hitboxes[idx]) { 
-    playerW = hitboxes[idx]->width;
-    playerH = hitboxes[idx]->height;
+  // Rooms never reopen once full, so only the most recent one can have free slots
+  if (_rooms.empty() || _rooms.back()->is_full() || _rooms.back()->is_finished())
+  {
+    _rooms.push_back(std::make_shared<room>(_socket, _nextRoomId++, _scheduler.tick_rate(), &_pool));
+    std::cout << "[Lobby] Opened room " << _rooms.back()->id() << "\n";
   }
-
-  constexpr float w = 17.f, h = 17.f;
-  float startX = pos.x + playerW - w * 0.2f;
-  float startY = pos.y + (playerH * 0.5f) - (h * 0.5f);
-
-  float dirX = 0.8f;
-  float dirY = -0.9f;
-  float speed = 2.2f;
-  uint32_t lifetime = 240;
-  int damage = 3;
-
-  return engine::make_entity(
-    _registry,
-    component::position{startX, startY}, component::velocity{dirX * speed, dirY * speed},
-    component::hitbox{w, h},
-    component::collision_state{false},
-    component::entity_kind::projectile_bomb,
-    component::projectile_tag{static_cast<uint32_t>(owner), lifetime, dirX, dirY, speed, damage},
-    component::gravity{0.03f},
-    component::health{1}
-  );
+  std::shared_ptr<room> r = _rooms.back();
+  r->add_player(sender);
+  push_route({sender, r});
+  if (r->is_full())
+    std::cout << "[Lobby] Room " << r->id() << " is full, starting match\n";
 }
 
-engine::entity_t server::spawn_player(engine::net::Endpoint endpoint, std::size_t index)
+void server::tick_rooms()
 {
-  float spawnX = 100.f;
-  float spawnY = 100.f + 120.f * static_cast<float>(index);
-  auto eid = engine::make_entity(
-      _registry, component::position{spawnX, spawnY}, component::velocity{0, 0},
-      component::hitbox{124, 70}, component::controllable{},
-      component::collision_state{false}, component::health{20},
-      component::damage{0}, component::entity_kind::player,
-      component::controlled_by{static_cast<uint32_t>(index)},
-      component::damage_cooldown{0});
-  return eid;
+  _activeRooms.clear();
+  for (auto &r : _rooms)
+  {
+    if (r->is_finished())
+      continue;
+    if (r->is_full())
+      _activeRooms.push_back(r.get());
+    else
+      r->drain_inbox(); // waiting room: still answer handshake retries
+  }
+  // Rooms share no state, so each one can run on any worker; the call returns once all ticked
+  // and rethrows the first exception a room tick threw, after the others finished
+  _pool.parallel_for(_activeRooms.size(), [this](std::size_t i) { _activeRooms[i]->tick(); });
+  for (room *r : _activeRooms)
+    _tickAllocations += r->last_tick_allocations();
 }
 
-engine::entity_t server::spawn_projectile(engine::entity_t owner)
+void server::close_finished_rooms()
 {
-    auto &positions = _registry.get_components<component::position>();
-    auto &hitboxes = _registry.get_components<component::hitbox>();
-    size_t idx = static_cast<size_t>(owner);
-    if (idx >= positions.size() || !positions[idx])
-        return owner;
-    auto pos = positions[idx].value();
-    float playerW = 0.f, playerH = 0.f;
-    if (idx < hitboxes.size() && hitboxes[idx])
+  for (auto it = _rooms.begin(); it != _rooms.end();)
+  {
+    if (!(*it)->is_finished())
     {
-        playerW = hitboxes[idx]->width;
-        playerH = hitboxes[idx]->height;
+      ++it;
+      continue;
     }
-    constexpr float projectileW = 72.f;
-    constexpr float projectileH = 24.f;
-    float startX = pos.x + playerW + 4.f;
-    float startY = pos.y + (playerH * 0.5f) - (projectileH * 0.5f);
-    auto proj = engine::make_entity(
-        _registry,
-    component::position{startX, startY}, component::velocity{2.f, 0.f},
-        component::hitbox{projectileW, projectileH},
-        component::collision_state{false},
-        component::entity_kind::playerProjectile,
-        component::projectile_tag{static_cast<uint32_t>(owner), 120, 1.f, 0.f, 2.f, 2},
-        component::health{1});
-    return proj;
+    // The network thread keeps its own reference until it has dropped these routes
+    for (auto &p : (*it)->players())
+      push_route({p.endpoint, nullptr});
+    std::cout << "[Lobby] Closed room " << (*it)->id() << "\n";
+    it = _rooms.erase(it);
+  }
 }
 
-engine::entity_t server::spawn_missile_explosion(float x, float y, int damage, float radius)
+void server::push_route(RouteUpdate &&update)
 {
-  float size = radius * 2.f;
-  float topLeftX = x - radius;
-  float topLeftY = y - radius;
-  auto e = engine::make_entity(
-    _registry,
-    component::position{topLeftX, topLeftY},
-    component::velocity{0.f, 0.f},
-    component::hitbox{size, size},
-    component::collision_state{false},
-    component::entity_kind::missile_explosion,
-    component::projectile_tag{0u, 30u, 0.f, 0.f, 0.f, damage},
-    component::area_effect{radius, damage, false},
-    component::health{1});
-  return e;
+  while (!_routeUpdates.try_push(std::move(update)))
+    std::this_thread::yield();
 }
@@ -1,109 +1,99 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
-#include <string>
 #include <vector>
-#include <random>
-#include "LevelManager.hpp"
-#include "engine/ecs/Registry.hpp"
-#include "engine/ecs/Components.hpp"
+#include "Room.hpp"
+#include "TickScheduler.hpp"
 #include "common/Packets.hpp"
 #include "engine/network/IoContext.hpp"
 #include "engine/network/UdpSocket.hpp"
 #include "engine/network/Endpoint.hpp"
-#define PLAYER_SPEED 400.0f
-#define SCREEN_WIDTH 1920
-#define SCREEN_HEIGHT 1080
+#include "engine/threading/SpscQueue.hpp"
+#include "engine/threading/ThreadPool.hpp"
 /**
  * @class server
- * @brief Main server class for managing game state, networking, and player entities.
+ * @brief Lobby hosting many concurrent matches (rooms) on one UDP socket.
  *
- * This class encapsulates the core logic for running the game server, including player registration,
- * network communication, game loop management, and entity handling using an ECS (Entity Component System) architecture.
+ * The server owns the network socket and the tick clock; game state lives in rooms. Each
+ * incoming packet is dispatched by sender endpoint to the room that player belongs to. A
+ * CONNECT_REQ from an unknown endpoint places the player in the open room (created on
+ * demand); a room starts ticking once it is full and is discarded when its match ends.
  *
- * @note Networking is provided via engine wrappers; Asio is encapsulated inside the engine.
+ * @section Threading
+ * - Network thread: the only reader of the socket. It routes each packet into the lock-free
+ *   inbox of its room and forwards CONNECT_REQs from unknown endpoints to the main thread.
+ * - Main thread: owns the tick clock and the room list. Every tick it seats new players,
+ *   then runs the due ticks of all full rooms in parallel on the worker pool and waits for
+ *   them before the next step.
+ * - The route table (endpoint -> room) belongs to the network thread; the main thread
+ *   changes it only through _routeUpdates, so no lock is shared between the two.
  *
- * @section Responsibilities
- * - Accepts and manages player connections via UDP.
- * - Handles game loop phases: waiting for players, processing inputs, updating game state, and broadcasting snapshots.
- * - Spawns and manages player and projectile entities.
- * - Centralizes entity removal logic to maintain ECS pipeline integrity.
+ * @note Networking is provided via engine wrappers; Asio is encapsulated inside the engine.
  *
  * @section Usage
- * Instantiate with an ASIO io_context and optional port, then call run() to start the server loop.
+ * Instantiate with an engine IoContext, optional port, tick rate and catch-up policy, then
+ * call run() to start the server loop.
  *
  * @section Members
- * - _registry: ECS registry for managing entities and components.
- * - _socket: UDP socket for network communication.
- * - _players: List of connected players and their associated entities.
- * - _live_entities: Set of currently active entities.
- * - _tick: Current server tick for synchronization.
- * - _gen: Random number generator for entity spawning and game logic.
+ * - _socket: UDP socket shared by every room.
+ * - _scheduler: Fixed-timestep clock (tick rate, catch-up policy) the main loop sleeps on.
+ * - _pool: Work-stealing workers ticking the rooms.
+ * - _rooms: Matches being filled or played (main thread).
+ * - _routes: Room of each connected player, keyed by endpoint (network thread).
+ * - _connectRequests / _routeUpdates: Queues between the network and main threads.
  */
-struct PlayerInfo
-{
-    engine::net::Endpoint endpoint;
-    engine::entity_t entityId;
-};
 class server
 {
     public:
-    server(engine::net::IoContext &ctx, unsigned short port = 4242);
+    server(engine::net::IoContext &ctx, unsigned short port = 4242, uint32_t tickRate = 60,
+           TickScheduler::CatchUp catchUp = TickScheduler::CatchUp::Burst,
+           uint32_t maxCatchUp = TickScheduler::default_max_catch_up,
+           std::size_t workers = engine::thread_pool::default_workers());
+    ~server();
     void run();
     void stop();
 
 private:
-    // Initialization / registration
-    void register_components();
-    void setup_systems();
-
-    // Sub-registrations (split from setup_systems)
-    void register_health_and_spawn_systems();
-    void register_projectile_movement_system();
-    void register_gravity_system();
-    void register_collision_system();
-    void register_bounds_system();
-    void register_area_effect_system();
+    // Route table change sent from the main thread to the network thread
+    struct RouteUpdate
+    {
+        engine::net::Endpoint key;
+        std::shared_ptr<room> target; // null removes the route
+    };
 
-    // Game loop phases
-    void wait_for_players();
-    void process_network_inputs();
-    void game_handler();
-    void broadcast_snapshot();
-    void broadcast_game_over(uint32_t winnerEntityId);
-    void check_game_over();
+    // Network thread
+    void network_loop();
+    void apply_route_updates();
+    void dispatch_packets();
 
-    // Spawning helpers
-    engine::entity_t spawn_player(engine::net::Endpoint endpoint, std::size_t index);
-    engine::entity_t spawn_projectile(engine::entity_t owner);
-    engine::entity_t spawn_projectile_basic(engine::entity_t owner);
-    engine::entity_t spawn_projectile_alt(engine::entity_t owner);
-    engine::entity_t spawn_projectile_charged(engine::entity_t owner, uint32_t heldTicks);
-    engine::entity_t spawn_projectile_bomb(engine::entity_t owner);
-    engine::entity_t spawn_missile_explosion(float x, float y, int damage, float radius);
+    // Main thread
+    void accept_connections();
+    void connect_player(const engine::net::Endpoint &sender);
+    void tick_rooms();
+    void close_finished_rooms();
+    void push_route(RouteUpdate &&update);
 
-    // Internal utility: ensure an entity is scheduled for removal by setting/adding despawn_tag.
-    // Centralises logic so systems never call kill_entity directly (uniform ECS pipeline).
 private:
-    bool _running = true;
-    engine::registry _registry;
+    std::atomic<bool> _running{true};
 
     engine::net::UdpSocket _socket;
-    engine::net::IoContext &_io;
-    unsigned short _port;
-
-
-    std::unordered_set<uint32_t> _live_entities;
-    std::vector<PlayerInfo> _players;
-    std::unique_ptr<LevelManager> _levelManager;
-
-    uint32_t _tick = 0;
+    TickScheduler _scheduler;
+    engine::thread_pool _pool;
+    std::thread _networkThread;
 
-    std::random_device rd;
-    std::mt19937 _gen{rd()};
+    std::vector<std::shared_ptr<room>> _rooms;
+    std::vector<room *> _activeRooms; // rooms ticked this step, reused every tick
+    uint64_t _tickAllocations = 0;     // heap allocations of room ticks since the last report
+    uint32_t _nextRoomId = 1;
 
-    // Input edge state per player
-    std::unordered_map<uint32_t, bool> _prevSpace;
-    std::unordered_map<uint32_t, bool> _prevC;
-    std::unordered_map<uint32_t, uint32_t> _pressTick;
+    std::unordered_map<engine::net::Endpoint, std::shared_ptr<room>> _routes;
+    std::unordered_set<engine::net::Endpoint> _pendingConnects; // forwarded, not routed yet
+    InboundPacket _inbound; // staging for packets routed to a room, reused
+    engine::spsc_queue<engine::net::Endpoint> _connectRequests{256};
+    engine::spsc_queue<RouteUpdate> _routeUpdates{1024};
 };
@@ -1,5 +1,6 @@
 #include "server/ServerUtils.hpp"
 #include "common/Packets.hpp"
+#include "common/SnapshotDelta.hpp"
 #include <algorithm>
 
 namespace serverutils {
@@ -19,10 +20,10 @@ namespace serverutils {
  * @param velocities Sparse array of velocity components for all entities.
  */
 void resolve_block(std::size_t moverIdx, std::size_t blockerIdx,
-                   engine::sparse_array<component::position> &positions,
+                   engine::storage_t<component::position> &positions,
                    engine::sparse_array<component::hitbox> &hitboxes,
                    engine::sparse_array<component::collision_state> &collisions,
-                   engine::sparse_array<component::velocity> &velocities) {
+                   engine::storage_t<component::velocity> &velocities) {
   if (moverIdx >= collisions.size() || !collisions[moverIdx] ||
       !positions[moverIdx] || !hitboxes[moverIdx] ||
       blockerIdx >= positions.size() || !positions[blockerIdx] ||
@@ -88,16 +89,18 @@ void apply_damage_with_cooldown(
   if (currentTick <= lastHitTick + 60)
     return;
 
+  // Missing components are added through the command buffer: this runs inside collision
+  // callbacks, while the registry's storages are being iterated.
   if (!damages[entityIndex])
-    reg.add_component(reg.entity_from_index(entityIndex), component::damage{1});
+    reg.commands().add(reg.entity_from_index(entityIndex), component::damage{1});
   else
     damages[entityIndex]->amount += 1;
 
   if (entityIndex < cooldowns.size() && cooldowns[entityIndex])
     cooldowns[entityIndex]->last_hit_tick = currentTick;
   else
-    reg.add_component(reg.entity_from_index(entityIndex),
-                      component::damage_cooldown{currentTick});
+    reg.commands().add(reg.entity_from_index(entityIndex),
+                       component::damage_cooldown{currentTick});
 
   if (entityIndex < collisions.size() && collisions[entityIndex])
     collisions[entityIndex]->collided = true;
@@ -105,18 +108,18 @@ void apply_damage_with_cooldown(
 
 void try_add_entity(uint32_t entityId, std::vector<EntityState> &out,
                     SnapshotBuilderContext &ctx,
-                    std::unordered_set<uint32_t> &inserted, std::size_t limit) {
+                    std::span<bool> inserted, std::size_t limit) {
   if (out.size() >= limit)
     return;
-  if (inserted.find(entityId) != inserted.end())
-    return;
 
   size_t idx = static_cast<size_t>(entityId);
   if (idx >= ctx.positions.size() || !ctx.positions[idx])
     return;
+  if (idx >= inserted.size() || inserted[idx])
+    return;
 
   EntityState es{};
-  es.entityId = entityId;
+  es.entityId = ctx.registry.entity_from_index(idx).handle();
   es.x = ctx.positions[idx]->x;
   es.y = ctx.positions[idx]->y;
 
@@ -152,8 +155,10 @@ void try_add_entity(uint32_t entityId, std::vector<EntityState> &out,
     es.hb_w = 0.f; es.hb_h = 0.f; es.hb_ox = 0.f; es.hb_oy = 0.f;
   }
 
+  // Snapshots travel quantized: diff and store what the client will decode
+  snapshot::quantize(es);
   out.push_back(es);
-  inserted.insert(entityId);
+  inserted[idx] = true;
 }
 
 }
@@ -3,7 +3,7 @@
 #include "common/Packets.hpp" // for EntityState
 #include "engine/ecs/Registry.hpp"
 #include <cstdint>
-#include <unordered_set>
+#include <span>
 #include <vector>
 
  // namespace serverutils
@@ -32,10 +32,10 @@ namespace serverutils {
  * @param velocities Reference to the array of velocity components.
  */
 void resolve_block(std::size_t moverIdx, std::size_t blockerIdx,
-                   engine::sparse_array<component::position> &positions,
+                   engine::storage_t<component::position> &positions,
                    engine::sparse_array<component::hitbox> &hitboxes,
                    engine::sparse_array<component::collision_state> &collisions,
-                   engine::sparse_array<component::velocity> &velocities);
+                   engine::storage_t<component::velocity> &velocities);
 
 /**
  * @brief Applies damage to an entity if its cooldown has expired.
@@ -58,15 +58,17 @@ void apply_damage_with_cooldown(
 /**
  * @brief Context structure for building entity snapshots.
  *
- * Holds references to relevant component arrays needed for snapshot construction.
+ * Holds references to relevant component arrays needed for snapshot construction,
+ * and the registry used to turn entity indices into generational network handles.
  */
 struct SnapshotBuilderContext {
-  engine::sparse_array<component::position> &positions;
-  engine::sparse_array<component::velocity> &velocities;
-  engine::sparse_array<component::entity_kind> &kinds;
+  engine::storage_t<component::position> &positions;
+  engine::storage_t<component::velocity> &velocities;
+  engine::storage_t<component::entity_kind> &kinds;
   engine::sparse_array<component::collision_state> &collisions;
   engine::sparse_array<component::health> &healths;
   engine::sparse_array<component::hitbox> &hitboxes;
+  engine::registry const &registry;
 };
 /**
  * @brief Attempts to add an entity to the snapshot output.
@@ -77,11 +79,11 @@ struct SnapshotBuilderContext {
  * @param entityId ID of the entity to add.
  * @param out Output vector of entity states.
  * @param ctx Context containing component arrays.
- * @param inserted Set of already inserted entity IDs.
+ * @param inserted Per entity index flag of the entities already inserted, sized to `ctx.positions`.
  * @param limit Maximum number of entities to add.
  */
 void try_add_entity(uint32_t entityId, std::vector<EntityState> &out,
                     SnapshotBuilderContext &ctx,
-                    std::unordered_set<uint32_t> &inserted, std::size_t limit);
+                    std::span<bool> inserted, std::size_t limit);
 
 }
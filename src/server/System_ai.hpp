@@ -11,7 +11,6 @@
 #include <unordered_map>
 #include "engine/ecs/Components.hpp"
 #include "engine/ecs/Registry.hpp"
-#include "engine/ecs/iterator/Indexed_zipper.hpp"
 #include "server/Components_ai.hpp"
 
 using namespace engine;
@@ -26,7 +25,8 @@ namespace systems
                                     component::ai_controller &)>;
 
   inline std::unordered_map<std::string, AiFunc> ai_dispatcher;
-  inline std::vector<engine::entity_t> spawned_projectiles;
+  // Per thread: rooms tick on pool workers and each drains the list right after its systems ran
+  inline thread_local std::vector<engine::entity_t> spawned_projectiles;
 
   /**
    * @brief Spawns a projectile with full configurable data.
@@ -51,7 +51,7 @@ namespace systems
         component::collision_state{false},
         component::entity_kind::enemyProjectile,
         component::projectile_tag{
-            static_cast<std::uint32_t>(owner),
+            owner.handle(),
             lifetime,
             dirX,
             dirY,
@@ -160,19 +160,16 @@ namespace systems
     };
   }
 
-  inline void enemy_ai_system(registry &r,
-                              sparse_array<component::position> &positions,
-                              sparse_array<component::velocity> &velocities,
-                              sparse_array<component::ai_controller> &ais,
-                              uint32_t tick)
+  // Runs the behavior of every AI entity, through a cached view of position/velocity/ai_controller
+  inline void enemy_ai_system(registry &r, uint32_t tick)
   {
-    for (auto &&[i, pos, vel, ai] :
-         indexed_zipper(positions, velocities, ais))
-    {
-      auto it = ai_dispatcher.find(ai.behavior);
-      if (it != ai_dispatcher.end())
-        it->second(r.entity_from_index(i), r, tick, pos, vel, ai);
-    }
+    r.view<component::position, component::velocity, component::ai_controller>().each(
+        [&](std::size_t i, component::position &pos, component::velocity &vel, component::ai_controller &ai)
+        {
+          auto it = ai_dispatcher.find(ai.behavior);
+          if (it != ai_dispatcher.end())
+            it->second(r.entity_from_index(i), r, tick, pos, vel, ai);
+        });
   }
 
 }
@@ -0,0 +1,72 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+/**
+ * @class TickScheduler
+ * @brief Fixed-timestep clock for the server simulation.
+ *
+ * Tracks the deadline of the next tick at a configurable rate. The server loop asks how many
+ * ticks are due, runs them, then sleeps (on socket readiness) until next_deadline().
+ *
+ * When the loop falls behind (slow tick, host preemption), the catch-up policy decides what
+ * happens to the missed ticks:
+ * - CatchUp::Burst: run them back to back, at most `maxCatchUp` per call; anything beyond
+ *   is dropped and the clock is resynchronised to now.
+ * - CatchUp::Skip: run a single tick and resynchronise, so the simulation slows down
+ *   instead of speeding up after a stall.
+ */
+class TickScheduler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    enum class CatchUp
+    {
+        Burst,
+        Skip,
+    };
+
+    static constexpr uint32_t default_max_catch_up = 5;
+
+    explicit TickScheduler(uint32_t tickRate = 60, CatchUp policy = CatchUp::Burst,
+                           uint32_t maxCatchUp = default_max_catch_up)
+        : _tickRate(std::max<uint32_t>(tickRate, 1)),
+          _period(std::chrono::duration_cast<clock::duration>(std::chrono::seconds(1)) / _tickRate),
+          _policy(policy), _maxCatchUp(std::max<uint32_t>(maxCatchUp, 1)), _next(clock::now())
+    {
+    }
+
+    uint32_t tick_rate() const { return _tickRate; }
+    clock::duration period() const { return _period; }
+    float dt() const { return 1.0f / static_cast<float>(_tickRate); }
+    clock::time_point next_deadline() const { return _next; }
+
+    // Restarts the schedule so that the first tick is due at `now`
+    void reset(clock::time_point now = clock::now()) { _next = now; }
+
+    /**
+     * @brief Returns how many ticks to run at `now` and advances the deadline accordingly.
+     */
+    uint32_t due(clock::time_point now)
+    {
+        if (now < _next)
+            return 0;
+        auto behind = static_cast<uint64_t>((now - _next) / _period) + 1;
+        uint32_t limit = _policy == CatchUp::Burst ? _maxCatchUp : 1;
+        if (behind > limit)
+        {
+            _next = now + _period;
+            return limit;
+        }
+        _next += _period * static_cast<int64_t>(behind);
+        return static_cast<uint32_t>(behind);
+    }
+
+private:
+    uint32_t _tickRate;
+    clock::duration _period;
+    CatchUp _policy;
+    uint32_t _maxCatchUp;
+    clock::time_point _next;
+};
@@ -0,0 +1,108 @@
+/**
+ * @file RoomAllocationTest.cpp
+ * @brief Checks that a room tick makes no heap allocation once its level is warmed up.
+ *
+ * Plays a full match on one room with two players sending input every tick (moving, firing
+ * and releasing charged shots, acknowledging snapshots a few ticks late) and counts the heap
+ * allocations of each tick with the operator new hook of AllocationCounter.cpp, which this
+ * test is always built with. The room ticks its systems serially, so every allocation happens
+ * on this thread and is counted. Any tick past room::allocation_warmup_ticks of its level that
+ * allocates fails the test, apart from the one ending the match.
+ */
+#include "server/Room.hpp"
+#include "server/System_ai.hpp"
+#include "common/Accessibility.hpp"
+#include "engine/network/IoContext.hpp"
+#include "engine/network/UdpSocket.hpp"
+#include "engine/profiling/AllocationCounter.hpp"
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t tick_rate = 60;
+  constexpr uint32_t max_ticks = 60 * 60; // longer than the three levels
+  constexpr uint32_t ack_delay = 3;       // snapshots in flight, as with a small round trip
+
+  // Actions held by player `index` at `tick`: a few seconds of each pattern
+  uint8_t scripted_actions(std::size_t index, uint32_t tick)
+  {
+    static constexpr uint8_t patterns[] = {
+        INPUT_RIGHT | INPUT_FIRE,
+        INPUT_UP,
+        INPUT_DOWN | INPUT_FIRE,
+        INPUT_LEFT,
+        INPUT_UP | INPUT_RIGHT | INPUT_BOMB,
+        0,
+    };
+    const uint32_t phase = tick / 90 + static_cast<uint32_t>(index);
+    uint8_t actions = patterns[phase % std::size(patterns)];
+    // Release the fire button now and then so that shots keep spawning
+    if ((tick % 20) == 0)
+      actions &= static_cast<uint8_t>(~(INPUT_FIRE | INPUT_BOMB));
+    return actions;
+  }
+
+  InboundPacket input_packet(const PlayerInfo &player, std::size_t index, uint32_t tick, uint32_t ackSequence)
+  {
+    InputPacket input{};
+    input.clientId = player.entityId.handle();
+    input.tick = tick;
+    input.ackSequence = ackSequence;
+    input.viewTick = INPUT_NO_TICK;
+    input.actions = scripted_actions(index, tick);
+
+    InboundPacket packet;
+    packet.assign(PacketHeader{INPUT_PKT, static_cast<uint16_t>(sizeof(InputPacket)), tick},
+                  {reinterpret_cast<const uint8_t *>(&input), sizeof(InputPacket)}, player.endpoint);
+    return packet;
+  }
+}
+
+int main()
+{
+  if (!Engine::Profiling::allocationCountingEnabled())
+  {
+    std::cerr << "room_allocation_test must be built with ENGINE_COUNT_ALLOCATIONS\n";
+    return 1;
+  }
+  AccessibilityConfig::load_from_json("configs/accessibility_config.json");
+  systems::init_ai_behaviors();
+
+  engine::net::IoContext io;
+  engine::net::UdpSocket socket(io, 0);
+  room r(socket, 1, tick_rate);
+  // Nobody listens on the players' ports: the snapshots sent to them are simply dropped
+  r.add_player(engine::net::make_endpoint("127.0.0.1", 47001));
+  r.add_player(engine::net::make_endpoint("127.0.0.1", 47002));
+
+  uint32_t checked = 0;
+  uint32_t failed = 0;
+  uint32_t snapshots = 0; // the room sends one snapshot per tick while players are in it
+  for (uint32_t tick = 0; tick < max_ticks && !r.is_finished(); ++tick)
+  {
+    const uint32_t ack = snapshots > ack_delay ? snapshots - 1 - ack_delay : SNAPSHOT_NO_BASELINE;
+    for (std::size_t i = 0; i < r.players().size(); ++i)
+      r.enqueue(input_packet(r.players()[i], i, tick, ack));
+    r.tick();
+    ++snapshots;
+
+    // The tick ending the match (game over, no next level) is not steady state
+    if (!r.warmed_up() || r.is_finished())
+      continue;
+    ++checked;
+    if (r.last_tick_allocations() != 0)
+    {
+      ++failed;
+      std::cerr << "tick " << tick << ": " << r.last_tick_allocations() << " heap allocations\n";
+    }
+  }
+
+  if (checked == 0)
+  {
+    std::cerr << "no tick ran past the warm-up\n";
+    return 1;
+  }
+  std::cout << checked << " warmed-up ticks checked, " << failed << " allocated\n";
+  return failed == 0 ? 0 : 1;
+}